@@ -0,0 +1,19 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#version 450 core
+
+in vec3	in_Position;
+in vec3	in_UV0;
+
+out vec3 pass_UV;
+
+void main(void)
+{
+	// Plane spans [-1, 1], draw as a full screen quad
+	gl_Position = vec4(in_Position.xy, 0.0, 1.0);
+
+	// Pass uv's
+	pass_UV = in_UV0;
+}
@@ -0,0 +1,32 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#version 450 core
+
+uniform UBO
+{
+	vec2 texelSize;			// Texel size of the source texture
+} ubo;
+
+in vec3 pass_UV;
+
+out vec4 out_Color;
+
+uniform sampler2D colorTexture;
+
+void main(void)
+{
+	// Every destination texel covers 2x2 source texels: the center tap averages those,
+	// the 4 diagonal taps average the surrounding texels, resulting in a small tent filter.
+	vec2 uv = pass_UV.xy;
+	vec2 d = ubo.texelSize;
+
+	vec4 color = texture(colorTexture, uv) * 4.0;
+	color += texture(colorTexture, uv + vec2(-d.x, -d.y));
+	color += texture(colorTexture, uv + vec2( d.x, -d.y));
+	color += texture(colorTexture, uv + vec2(-d.x,  d.y));
+	color += texture(colorTexture, uv + vec2( d.x,  d.y));
+
+	out_Color = color / 8.0;
+}
@@ -0,0 +1,43 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#version 450 core
+
+uniform UBO
+{
+	vec2 texelSize;			// Texel size of the low resolution texture
+	float radius;			// Tent filter radius in texels
+	float highWeight;		// Weight of the high resolution texture, 0 to ignore
+	float intensity;		// Output multiplier
+} ubo;
+
+in vec3 pass_UV;
+
+out vec4 out_Color;
+
+uniform sampler2D lowTexture;
+uniform sampler2D highTexture;
+
+void main(void)
+{
+	// 3x3 tent filter on the lower level
+	vec2 uv = pass_UV.xy;
+	vec2 d = ubo.texelSize * ubo.radius;
+
+	vec4 color = texture(lowTexture, uv) * 4.0;
+	color += texture(lowTexture, uv + vec2(-d.x, 0.0)) * 2.0;
+	color += texture(lowTexture, uv + vec2( d.x, 0.0)) * 2.0;
+	color += texture(lowTexture, uv + vec2(0.0, -d.y)) * 2.0;
+	color += texture(lowTexture, uv + vec2(0.0,  d.y)) * 2.0;
+	color += texture(lowTexture, uv + vec2(-d.x, -d.y));
+	color += texture(lowTexture, uv + vec2( d.x, -d.y));
+	color += texture(lowTexture, uv + vec2(-d.x,  d.y));
+	color += texture(lowTexture, uv + vec2( d.x,  d.y));
+	color /= 16.0;
+
+	// Combine with the current level
+	color += texture(highTexture, uv) * ubo.highWeight;
+
+	out_Color = vec4(color.rgb * ubo.intensity, 1.0);
+}
@@ -9,6 +9,9 @@ uniform UBO
 	float blend;
 	float abberation;
 	float brightness;
+	float fxBrightness;
+	float fxContrast;
+	float fxSaturation;
 } ubo;
 
 in vec3 pass_UV;
@@ -40,11 +43,21 @@ vec3 brightness(vec3 color, float value)
 	return clamp(color + value, 0.0, 1.0);
 } 
 
+// Color change of the bloom layer. Affine, so it commutes with the normalized bloom blur:
+// applying it here equals applying it to the bloom input, apart from clamping.
+vec3 change_color(vec3 color)
+{
+	color = (color - 0.5) * (1.0 + ubo.fxContrast) + 0.5 + ubo.fxBrightness;
+	float luma = dot(color, vec3(0.2126, 0.7152, 0.0722));
+	return mix(vec3(luma), color, ubo.fxSaturation);
+}
+
 void main(void)
 {	
 	// Get texel color values
 	vec4 col0 = chromatic_abberation_sample(colorTextures[0], pass_UV.xy);
 	vec4 col1 = texture(colorTextures[1], pass_UV.xy);
+	col1.rgb = change_color(col1.rgb);
 
 	// // Get screened blend color
 	// const vec3 vunit = vec3(1.0, 1.0, 1.0);
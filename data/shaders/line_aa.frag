@@ -0,0 +1,28 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#version 450 core
+
+uniform UBO
+{
+	vec2 viewport;			// Target size in pixels
+	float width;			// Line width in pixels
+	float feather;			// Anti-aliased edge width in pixels
+	int count;				// Number of active line vertices
+} ubo;
+
+in vec4 pass_Color;
+noperspective in float pass_Distance;
+noperspective in vec2 pass_Cap;
+
+out vec4 out_Color;
+
+void main()
+{
+	// Analytic coverage: 1 inside the line, falls off linearly over the feather at the sides and the caps
+	float feather = max(ubo.feather, 0.0001);
+	float coverage = clamp((ubo.width * 0.5 + feather * 0.5 - abs(pass_Distance)) / feather, 0.0, 1.0);
+	coverage *= clamp((feather * 0.5 - max(pass_Cap.x, pass_Cap.y)) / feather, 0.0, 1.0);
+	out_Color = vec4(pass_Color.rgb, pass_Color.a * coverage);
+}
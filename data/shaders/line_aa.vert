@@ -0,0 +1,115 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#version 450 core
+
+uniform nap
+{
+	mat4 projectionMatrix;
+	mat4 viewMatrix;
+	mat4 modelMatrix;
+} mvp;
+
+uniform UBO
+{
+	vec2 viewport;			// Target size in pixels
+	float width;			// Line width in pixels
+	float feather;			// Anti-aliased edge width in pixels
+	int count;				// Number of active line vertices
+} ubo;
+
+// Line vertices, written by the line compute shader
+layout(std430) restrict readonly buffer Positions
+{
+	vec4 positions[];
+};
+
+layout(std430) restrict readonly buffer Colors
+{
+	vec4 colors[];
+};
+
+out vec4 pass_Color;
+noperspective out float pass_Distance;
+noperspective out vec2 pass_Cap;
+
+// Quad corners of a segment: x selects the start or end vertex, y the side of the line
+const vec2 corners[6] = vec2[]
+(
+	vec2(0.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+	vec2(0.0, -1.0), vec2(1.0, 1.0), vec2(0.0, 1.0)
+);
+
+// Shortest miter, limits the spike of sharp joins to 4 times the line width
+const float minMiterScale = 0.25;
+
+// Distance along the line outside of the caps, always covered
+const float noCap = -1.0e6;
+
+// Line vertex in screen space pixels
+vec2 toScreen(int index, mat4 mvpMatrix, vec2 halfViewport)
+{
+	vec4 clip = mvpMatrix * positions[clamp(index, 0, ubo.count - 1)];
+	return clip.xy / clip.w * halfViewport;
+}
+
+// Normalized direction, falls back to the x axis for degenerate segments
+vec2 direction(vec2 from, vec2 to)
+{
+	vec2 dir = to - from;
+	float len = length(dir);
+	return len > 0.0001 ? dir / len : vec2(1.0, 0.0);
+}
+
+void main(void)
+{
+	// Every segment is drawn as 2 triangles, no vertex buffers are bound
+	int segment = gl_VertexIndex / 6;
+	vec2 corner = corners[gl_VertexIndex % 6];
+	int index = corner.x < 0.5 ? segment : segment + 1;
+
+	// Vertex and its neighbours in screen space
+	mat4 mvp_matrix = mvp.projectionMatrix * mvp.viewMatrix * mvp.modelMatrix;
+	vec2 half_viewport = ubo.viewport * 0.5;
+	vec2 previous = toScreen(index - 1, mvp_matrix, half_viewport);
+	vec2 current = toScreen(index, mvp_matrix, half_viewport);
+	vec2 next = toScreen(index + 1, mvp_matrix, half_viewport);
+
+	// Segments share the offset of the vertex in between: the miter of both directions, so quads meet
+	// at the join without overlapping. Ends use the direction of their only segment.
+	bool first = index == 0;
+	bool last = index == ubo.count - 1;
+	vec2 dir_in = first ? direction(current, next) : direction(previous, current);
+	vec2 dir_out = last ? dir_in : direction(current, next);
+	vec2 tangent = dir_in + dir_out;
+	tangent = dot(tangent, tangent) > 0.000001 ? normalize(tangent) : dir_in;
+	vec2 miter = vec2(-tangent.y, tangent.x);
+	vec2 normal = vec2(-dir_in.y, dir_in.x);
+
+	// Expand to the line width plus feather, the projection of the miter on the normal equals the extent
+	float extent = ubo.width * 0.5 + ubo.feather;
+	vec2 offset = miter * corner.y * extent / max(dot(miter, normal), minMiterScale);
+
+	// Extend the ends by the feather, so the caps fade out as well
+	vec2 segment_start = corner.x < 0.5 ? current : previous;
+	vec2 segment_end = corner.x < 0.5 ? next : current;
+	vec2 segment_dir = direction(segment_start, segment_end);
+	float segment_length = distance(segment_start, segment_end);
+	if (first)
+		offset -= segment_dir * ubo.feather;
+	if (last)
+		offset += segment_dir * ubo.feather;
+
+	// Distance beyond the start (x) and end (y) of the line, only on the first and last segment
+	float along = corner.x < 0.5 ? 0.0 : segment_length;
+	pass_Cap.x = segment == 0 ? (first ? ubo.feather : -along) : noCap;
+	pass_Cap.y = segment == ubo.count - 2 ? (last ? ubo.feather : along - segment_length) : noCap;
+
+	vec4 clip = mvp_matrix * positions[index];
+	clip.xy += offset / half_viewport * clip.w;
+	gl_Position = clip;
+
+	pass_Distance = corner.y * extent;
+	pass_Color = colors[index];
+}
@@ -7,13 +7,20 @@
 RTTI_BEGIN_CLASS(nap::AppState)
     RTTI_PROPERTY("CapFramerate", &nap::AppState::mCapFramerate, nap::rtti::EPropertyMetaData::Default)
     RTTI_PROPERTY("FramesPerSecond", &nap::AppState::mFramesPerSecond, nap::rtti::EPropertyMetaData::Default)
+    RTTI_PROPERTY("PreviewFramesPerSecond", &nap::AppState::mPreviewFramesPerSecond, nap::rtti::EPropertyMetaData::Default)
+    RTTI_PROPERTY("GUIFramesPerSecond", &nap::AppState::mGUIFramesPerSecond, nap::rtti::EPropertyMetaData::Default)
     RTTI_PROPERTY("HideCursor", &nap::AppState::mHideCursor, nap::rtti::EPropertyMetaData::Default)
+    RTTI_PROPERTY("CullHiddenPreview", &nap::AppState::mCullHiddenPreview, nap::rtti::EPropertyMetaData::Default)
+    RTTI_PROPERTY("GovernQuality", &nap::AppState::mGovernQuality, nap::rtti::EPropertyMetaData::Default)
 RTTI_END_CLASS
 
 namespace nap
 {
 	bool AppState::init(utility::ErrorState& errorState)
 	{
+		if (!errorState.check(mPreviewFramesPerSecond >= 0.0f && mGUIFramesPerSecond >= 0.0f, "%s: preview and GUI framerate can't be negative", mID.c_str()))
+			return false;
+
 		return true;
 	}
 }
@@ -20,8 +20,12 @@ namespace nap
     public:
         // Properties
         bool mCapFramerate = false;         ///< Property: 'CapFramerate' When true, cap the application framerate
-        float mFramesPerSecond = 60.0f;     ///< Property: 'FramesPerSecond' Target framerate when capping is enabled
+        float mFramesPerSecond = 60.0f;     ///< Property: 'FramesPerSecond' Target framerate when capping is enabled, drives the compute and laser tick
+        float mPreviewFramesPerSecond = 30.0f;  ///< Property: 'PreviewFramesPerSecond' Max preview window render rate, 0 renders every frame
+        float mGUIFramesPerSecond = 30.0f;  ///< Property: 'GUIFramesPerSecond' Max control window render rate, 0 renders every frame
         bool mHideCursor = false;           ///< Property: 'HideCursor' When true, hide the OS cursor
+        bool mCullHiddenPreview = true;     ///< Property: 'CullHiddenPreview' When true, skip all preview passes while the preview window is minimized or hidden
+        bool mGovernQuality = true;         ///< Property: 'GovernQuality' When true, lower preview quality while frames exceed their budget
 
         bool init(utility::ErrorState &errorState) override;
     };
@@ -4,12 +4,15 @@
 
 // Local Includes
 #include "computelinecomponent.h"
+#include "laseroutputcomponent.h"
 
 // External Includes
 #include <entity.h>
+#include <nap/core.h>
 #include <glm/gtc/noise.hpp>
 #include <nap/logger.h>
 #include <glm/gtc/random.hpp>
+#include <glm/gtc/constants.hpp>
 #include <renderglobals.h>
 
 RTTI_BEGIN_STRUCT(nap::NoiseProperties)
@@ -26,9 +29,21 @@ RTTI_BEGIN_STRUCT(nap::NoiseProperties)
 	RTTI_PROPERTY("SmoothTime",			&nap::NoiseProperties::mSmoothTime,			nap::rtti::EPropertyMetaData::Default)
 RTTI_END_STRUCT
 
+RTTI_BEGIN_STRUCT(nap::LineLODProperties)
+	RTTI_PROPERTY("Enable",				&nap::LineLODProperties::mEnable,			nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("MinCount",			&nap::LineLODProperties::mMinCount,			nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("CurvatureWeight",	&nap::LineLODProperties::mCurvatureWeight,	nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("Hysteresis",			&nap::LineLODProperties::mHysteresis,		nap::rtti::EPropertyMetaData::Default)
+RTTI_END_STRUCT
+
 RTTI_BEGIN_CLASS(nap::ComputeLineComponent)
 	RTTI_PROPERTY("LineMesh",			&nap::ComputeLineComponent::mLineMesh,		nap::rtti::EPropertyMetaData::Required)
 	RTTI_PROPERTY("Properties",			&nap::ComputeLineComponent::mProperties,	nap::rtti::EPropertyMetaData::Required | nap::rtti::EPropertyMetaData::Embedded)
+	RTTI_PROPERTY("LOD",				&nap::ComputeLineComponent::mLOD,			nap::rtti::EPropertyMetaData::Default | nap::rtti::EPropertyMetaData::Embedded)
+	RTTI_PROPERTY("Count",				&nap::ComputeLineComponent::mCount,			nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("SimulationClock",	&nap::ComputeLineComponent::mSimulationClock,	nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("SmoothingEngine",	&nap::ComputeLineComponent::mSmoothingEngine,	nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("ParameterSnapshot",	&nap::ComputeLineComponent::mParameterSnapshot,	nap::rtti::EPropertyMetaData::Default)
 	RTTI_PROPERTY("ClockSpeed",			&nap::ComputeLineComponent::mClockSpeed,	nap::rtti::EPropertyMetaData::Default)
 	RTTI_PROPERTY("Readback",			&nap::ComputeLineComponent::mReadback,		nap::rtti::EPropertyMetaData::Default)
 	RTTI_PROPERTY("ResetStorage",		&nap::ComputeLineComponent::mResetStorage,	nap::rtti::EPropertyMetaData::Default)
@@ -48,11 +63,71 @@ namespace nap
 	}
 
 
+	// Utility function to get root entity
+	static EntityInstance* findRootEntity(EntityInstance* entity)
+	{
+		EntityInstance* last_entity = entity;
+		while (entity != nullptr)
+		{
+			last_entity = entity;
+			entity = entity->getParent();
+		}
+		return last_entity;
+	}
+
+
+	// Total turning angle of a line in half turns, used as a measure of line curvature
+	static float getHalfTurns(const std::vector<glm::vec4>& positions)
+	{
+		float angle = 0.0f;
+		for (uint i = 2; i < positions.size(); i++)
+		{
+			const glm::vec3 a = glm::vec3(positions[i-1]) - glm::vec3(positions[i-2]);
+			const glm::vec3 b = glm::vec3(positions[i]) - glm::vec3(positions[i-1]);
+			const float len = glm::length(a) * glm::length(b);
+			if (len > glm::epsilon<float>())
+				angle += glm::acos(glm::clamp(glm::dot(a, b) / len, -1.0f, 1.0f));
+		}
+		return angle / glm::pi<float>();
+	}
+
+
+	LineModulation LineModulation::lerp(const LineModulation& a, const LineModulation& b, double t)
+	{
+		LineModulation result;
+		result.mElapsedClockTime = glm::mix(a.mElapsedClockTime, b.mElapsedClockTime, t);
+		result.mWavelength = glm::mix(a.mWavelength, b.mWavelength, t);
+		result.mAmplitude = glm::mix(a.mAmplitude, b.mAmplitude, t);
+		result.mOffset = glm::mix(a.mOffset, b.mOffset, t);
+		result.mShift = glm::mix(a.mShift, b.mShift, t);
+		return result;
+	}
+
+
+	void ComputeLineComponentInstance::LineSimulation::step(double time, double deltaTime)
+	{
+		mLine.mSnapshots.publish(time, mLine.advance(time, deltaTime));
+	}
+
+
 	ComputeLineComponentInstance::ComputeLineComponentInstance(EntityInstance& entity, Component& resource) :
 		ComputeComponentInstance(entity, resource)
 	{ }
 
 
+	ComputeLineComponentInstance::~ComputeLineComponentInstance()
+	{
+		if (mSimulationClock != nullptr)
+			mSimulationClock->removeSimulation(mSimulation);
+
+		if (mSmoothingEngine != nullptr)
+		{
+			for (auto& smoother : mSmoothers)
+				mSmoothingEngine->remove(smoother);
+		}
+	}
+
+
 	bool ComputeLineComponentInstance::init(utility::ErrorState& errorState)
 	{
 		if (!ComputeComponentInstance::init(errorState))
@@ -64,6 +139,7 @@ namespace nap
 		mLineMesh = resource->mLineMesh.get();
 		mReadback = resource->mReadback;
 		mResetStorage = resource->mResetStorage;
+		mLOD = resource->mLOD;
 
 		// Buffer bindings
 		createBufferBinding("OutPositions", mLineMesh->getPositionBuffer(LineMesh::EBufferRank::Write), getMaterialInstance());
@@ -73,15 +149,61 @@ namespace nap
 		createBufferBinding("InUVs", mLineMesh->getUVBuffer(LineMesh::EBufferRank::Read), getMaterialInstance());
 		createBufferBinding("InColors", mLineMesh->getColorBuffer(LineMesh::EBufferRank::Read), getMaterialInstance());
 
-		// Set smooth timing values
-		for (auto* smoother : { &mAmplitudeSmoother, &mWavelengthSmoother, &mOffsetSmoother, &mSpeedSmoother, &mShiftSmoother })
-			smoother->mSmoothTime = mProperties.mSmoothTime;
+		// Resolution control, applied on the next frame
+		if (resource->mCount != nullptr)
+		{
+			mLineMesh->resize(resource->mCount->mValue);
+			resource->mCount->valueChanged.connect(mCountChangedSlot);
+		}
+
+		// Add the smoothed values to the shared engine, all lines are smoothed in a single step
+		mSmoothingEngine = resource->mSmoothingEngine.get();
+		if (mSmoothingEngine == nullptr)
+		{
+			mPrivateSmoothingEngine = std::make_unique<SmoothingEngine>();
+			mPrivateSmoothingEngine->mCapacity = static_cast<int>(mSmoothers.size());
+			if (!mPrivateSmoothingEngine->init(errorState))
+				return false;
+			mSmoothingEngine = mPrivateSmoothingEngine.get();
+		}
 
-		mAmplitudeSmoother.setValue(mProperties.mAmplitude->mValue);
-		mWavelengthSmoother.setValue(mProperties.mWavelength->mValue);
-		mOffsetSmoother.setValue(mProperties.mOffset->mValue);
-		mSpeedSmoother.setValue(mProperties.mClockSpeed->mValue);
-		mShiftSmoother.setValue(mProperties.mShift->mValue);
+		mTargets = { mProperties.mClockSpeed->mValue, mProperties.mWavelength->mValue, mProperties.mAmplitude->mValue, mProperties.mOffset->mValue, mProperties.mShift->mValue };
+		for (size_t i = 0; i < mSmoothers.size(); i++)
+		{
+			mSmoothers[i] = mSmoothingEngine->add(static_cast<float>(mTargets[i]), mProperties.mSmoothTime);
+			if (!errorState.check(mSmoothers[i].isValid(), "%s: %s is full, increase its 'Capacity'", mID.c_str(), mSmoothingEngine->mID.c_str()))
+				return false;
+		}
+
+		// Read the targets from the snapshot, all of them must be published
+		if (resource->mParameterSnapshot != nullptr)
+		{
+			mParameterSnapshot = resource->mParameterSnapshot.get();
+			const std::array<const ParameterFloat*, 5> parameters = { mProperties.mClockSpeed.get(), mProperties.mWavelength.get(),
+				mProperties.mAmplitude.get(), mProperties.mOffset.get(), mProperties.mShift.get() };
+			for (size_t i = 0; i < parameters.size(); i++)
+			{
+				mSnapshotSlots[i] = mParameterSnapshot->findSlot(parameters[i]->mID);
+				if (!errorState.check(mSnapshotSlots[i] >= 0, "%s: parameter %s is not part of snapshot %s", mID.c_str(),
+					parameters[i]->mID.c_str(), mParameterSnapshot->mID.c_str()))
+					return false;
+			}
+		}
+
+		// Start from the unmodulated values, the simulation clock publishes its first steps after init
+		LineModulation initial;
+		initial.mWavelength = mTargets[1];
+		initial.mAmplitude = mTargets[2];
+		initial.mOffset = mTargets[3];
+		initial.mShift = mTargets[4];
+		setModulation(initial);
+
+		// Advance at a fixed rate from now on
+		if (resource->mSimulationClock != nullptr)
+		{
+			mSimulationClock = resource->mSimulationClock.get();
+			mSimulationClock->addSimulation(mSimulation);
+		}
 
 		mRandomSeed =
 		{
@@ -90,7 +212,26 @@ namespace nap
 			glm::linearRand<float>(0.0f, 1000.0f)
 		};
 
-		setInvocations(resource->mLineMesh->getMeshInstance().getNumVertices());
+		// LOD resamples the original line, which requires the storage to be reset every frame
+		if (mLOD.mEnable && !mResetStorage)
+		{
+			nap::Logger::warn("%s: LOD requires 'ResetStorage', using all %d vertices", mID.c_str(), mLineMesh->getCapacity());
+			mLOD.mEnable = false;
+		}
+
+		// Gather the laser outputs that draw this line, their point budget drives the LOD
+		if (mLOD.mEnable)
+		{
+			std::vector<LaserOutputComponentInstance*> outputs;
+			findRootEntity(getEntityInstance())->getComponentsOfTypeRecursive(outputs);
+			for (auto* output : outputs)
+			{
+				if (output->getComponent<LaserOutputComponent>()->mLineMesh.get() == mLineMesh)
+					mLaserOutputs.emplace_back(output);
+			}
+		}
+
+		setInvocations(mLineMesh->getActiveCount());
 
 		return true;
 	}
@@ -101,27 +242,112 @@ namespace nap
 		if (!mEnabled)
 			return;
 
-		// Update smoothers
-		mSpeedSmoother.update(mProperties.mClockSpeed->mValue, deltaTime);
-		mWavelengthSmoother.update(mProperties.mWavelength->mValue, deltaTime);
-		mAmplitudeSmoother.update(mProperties.mAmplitude->mValue, deltaTime);
-		mOffsetSmoother.update(mProperties.mOffset->mValue, deltaTime);
-		mShiftSmoother.update(mProperties.mShift->mValue, deltaTime);
+		// Apply pending resolution changes before any commands are recorded for this frame
+		utility::ErrorState error_state;
+		if (!mLineMesh->applyResize(error_state))
+			nap::Logger::error("%s: %s", mID.c_str(), error_state.toString().c_str());
 
-		// Update current time
-		mElapsedClockTime += (deltaTime * mSpeedSmoother.getValue() * mClockSpeed);
+		// Update active vertex count
+		if (mLOD.mEnable)
+			updateLOD();
+		setInvocations(mLineMesh->getActiveCount());
+
+		// Update smoother targets, the snapshot is published by the service after the frame
+		if (mParameterSnapshot == nullptr)
+		{
+			std::lock_guard<std::mutex> lock(mTargetMutex);
+			mTargets = { mProperties.mClockSpeed->mValue, mProperties.mWavelength->mValue, mProperties.mAmplitude->mValue, mProperties.mOffset->mValue, mProperties.mShift->mValue };
+		}
+
+		// Values that aren't modulated are set every frame, also before the simulation published its first steps
 		auto* ubo = getMaterialInstance().getOrCreateUniform("UBO"); assert(ubo != nullptr);
-		ubo->getOrCreateUniform<UniformFloatInstance>("elapsedTime")->setValue(static_cast<float>(mElapsedClockTime));
-		ubo->getOrCreateUniform<UniformFloatInstance>("wavelength")->setValue(mWavelengthSmoother.getValue());
-		ubo->getOrCreateUniform<UniformFloatInstance>("amplitude")->setValue(mAmplitudeSmoother.getValue());
-		ubo->getOrCreateUniform<UniformFloatInstance>("offset")->setValue(mOffsetSmoother.getValue());
-		ubo->getOrCreateUniform<UniformFloatInstance>("shift")->setValue(mShiftSmoother.getValue());
 		ubo->getOrCreateUniform<UniformFloatInstance>("timeshift")->setValue(mProperties.mTimeShift->mValue);
 		ubo->getOrCreateUniform<UniformVec4Instance>("colorOne")->setValue(mProperties.mColorOne->mValue.toVec4());
 		ubo->getOrCreateUniform<UniformVec4Instance>("colorTwo")->setValue(mProperties.mColorTwo->mValue.toVec4());
 		ubo->getOrCreateUniform<UniformFloatInstance>("alpha")->setValue(mProperties.mOpacity->mValue);
 		ubo->getOrCreateUniform<UniformFloatInstance>("brightness")->setValue(mProperties.mBrightness->mValue);
-		ubo->getOrCreateUniform<UniformUIntInstance>("count")->setValue(mLineMesh->getMeshInstance().getNumVertices());
+		ubo->getOrCreateUniform<UniformUIntInstance>("count")->setValue(mLineMesh->getActiveCount());
+		ubo->getOrCreateUniform<UniformUIntInstance>("capacity")->setValue(mLineMesh->getCapacity());
+
+		// Advance with the frame, or interpolate the fixed rate simulation. Until it published two steps
+		// the modulation keeps the values of the last frame, initially the unmodulated values set on init.
+		LineModulation modulation;
+		if (mSimulationClock == nullptr)
+			modulation = advance(getEntityInstance()->getCore()->getElapsedTime(), deltaTime);
+		else if (!mSnapshots.sample(mSimulationClock->getRenderTime(), modulation))
+			return;
+		setModulation(modulation);
+	}
+
+
+	void ComputeLineComponentInstance::setModulation(const LineModulation& modulation)
+	{
+		auto* ubo = getMaterialInstance().getOrCreateUniform("UBO"); assert(ubo != nullptr);
+		ubo->getOrCreateUniform<UniformFloatInstance>("elapsedTime")->setValue(static_cast<float>(modulation.mElapsedClockTime));
+		ubo->getOrCreateUniform<UniformFloatInstance>("wavelength")->setValue(modulation.mWavelength);
+		ubo->getOrCreateUniform<UniformFloatInstance>("amplitude")->setValue(modulation.mAmplitude);
+		ubo->getOrCreateUniform<UniformFloatInstance>("offset")->setValue(modulation.mOffset);
+		ubo->getOrCreateUniform<UniformFloatInstance>("shift")->setValue(modulation.mShift);
+	}
+
+
+	LineModulation ComputeLineComponentInstance::advance(double time, double deltaTime)
+	{
+		std::array<double, 5> targets;
+		if (mParameterSnapshot != nullptr)
+		{
+			mParameterSnapshot->read(mSnapshotView);
+			for (size_t i = 0; i < targets.size(); i++)
+				targets[i] = mSnapshotView.getFloat(mSnapshotSlots[i]);
+		}
+		else
+		{
+			std::lock_guard<std::mutex> lock(mTargetMutex);
+			targets = mTargets;
+		}
+
+		// Update smoothers, the engine steps once for all lines that share it
+		for (size_t i = 0; i < mSmoothers.size(); i++)
+			mSmoothingEngine->setTarget(mSmoothers[i], static_cast<float>(targets[i]));
+		mSmoothingEngine->step(time, deltaTime);
+
+		// Update current time
+		mElapsedClockTime += (deltaTime * mSmoothingEngine->getValue(mSmoothers[0]) * mClockSpeed);
+
+		LineModulation modulation;
+		modulation.mElapsedClockTime = mElapsedClockTime;
+		modulation.mWavelength = mSmoothingEngine->getValue(mSmoothers[1]);
+		modulation.mAmplitude = mSmoothingEngine->getValue(mSmoothers[2]);
+		modulation.mOffset = mSmoothingEngine->getValue(mSmoothers[3]);
+		modulation.mShift = mSmoothingEngine->getValue(mSmoothers[4]);
+		return modulation;
+	}
+
+
+	void ComputeLineComponentInstance::updateLOD()
+	{
+		// Largest point budget of all enabled outputs, use all vertices when the line isn't sent to a laser
+		int budget = 0;
+		for (const auto* output : mLaserOutputs)
+		{
+			if (output->isEnabled())
+				budget = std::max(budget, output->getPointsPerFrame());
+		}
+		if (budget <= 0)
+		{
+			mLineMesh->setActiveCount(mLineMesh->getResolution());
+			return;
+		}
+
+		// Curved lines require more vertices to resample without visible corners
+		const float curvature = getHalfTurns(mLineMesh->getPositionsLocal());
+		const float target = static_cast<float>(budget) * (1.0f + mLOD.mCurvatureWeight * curvature);
+		const uint count = std::clamp<uint>(static_cast<uint>(target), std::min(mLOD.mMinCount, mLineMesh->getResolution()), mLineMesh->getResolution());
+
+		// Only update when the change is significant, prevents the count from flickering every frame
+		const float current = static_cast<float>(mLineMesh->getActiveCount());
+		if (glm::abs(static_cast<float>(count) - current) > current * mLOD.mHysteresis)
+			mLineMesh->setActiveCount(count);
 	}
 
 
@@ -139,6 +365,12 @@ namespace nap
 		binding = getMaterialInstance().getOrCreateBuffer<BufferBindingVec4Instance>("OutPositions");
 		binding->setBuffer(mLineMesh->getPositionBuffer(LineMesh::EBufferRank::Write));
 
+		binding = getMaterialInstance().getOrCreateBuffer<BufferBindingVec4Instance>("InNormals");
+		binding->setBuffer(mLineMesh->getNormalBuffer(LineMesh::EBufferRank::Read));
+
+		binding = getMaterialInstance().getOrCreateBuffer<BufferBindingVec4Instance>("InUVs");
+		binding->setBuffer(mLineMesh->getUVBuffer(LineMesh::EBufferRank::Read));
+
 		binding = getMaterialInstance().getOrCreateBuffer<BufferBindingVec4Instance>("InColors");
 		binding->setBuffer(mLineMesh->getColorBuffer(LineMesh::EBufferRank::Read));
 
@@ -5,15 +5,21 @@
 
 #include <component.h>
 #include <componentptr.h>
-#include <smoothdamp.h>
 #include <parameternumeric.h>
 #include <computecomponent.h>
 #include <linemesh.h>
 #include <parametercolor.h>
+#include <array>
+#include <mutex>
+
+#include "simulationclock.h"
+#include "smoothingengine.h"
+#include "parametersnapshot.h"
 
 namespace nap
 {
 	class ComputeLineComponentInstance;
+	class LaserOutputComponentInstance;
 
 	/**
 	 * Properties associated with the line noise modulation component
@@ -34,6 +40,37 @@ namespace nap
 	};
 
 
+	/**
+	 * Level of detail settings of the line.
+	 * When enabled, the number of active vertices is derived from the point budget of the laser outputs that draw
+	 * the line (point rate / frame rate), scaled up by the curvature of the line. The GPU buffers keep their size,
+	 * only the number of computed, read back and drawn vertices changes.
+	 */
+	struct NAPAPI LineLODProperties
+	{
+		bool mEnable = false;								//< Property: 'Enable' derive the active vertex count from the laser point budget
+		uint mMinCount = 64;								//< Property: 'MinCount' lower bound of the active vertex count
+		float mCurvatureWeight = 0.1f;						//< Property: 'CurvatureWeight' budget increase per half turn of the line, 0 to ignore curvature
+		float mHysteresis = 0.05f;							//< Property: 'Hysteresis' relative change required before the active count is updated
+	};
+
+
+	/**
+	 * Smoothed modulation values of a line
+	 */
+	struct NAPAPI LineModulation
+	{
+		double mElapsedClockTime = 0.0;						//< Line clock
+		double mWavelength = 1.0;							//< Smoothed wavelength
+		double mAmplitude = 1.0;							//< Smoothed amplitude
+		double mOffset = 0.0;								//< Smoothed offset
+		double mShift = 0.0;								//< Smoothed shift
+
+		// Interpolates between two states, see SnapshotBuffer
+		static LineModulation lerp(const LineModulation& a, const LineModulation& b, double t);
+	};
+
+
 	/**
 	 * Resource of the LineNoiseComponent
 	 */
@@ -44,6 +81,11 @@ namespace nap
 	public:
 		ResourcePtr<LineMesh> mLineMesh;				//< Property 'LineMesh':
 		NoiseProperties mProperties;					//< Property 'Properties': all modulation settings
+		LineLODProperties mLOD;							//< Property 'LOD': level of detail settings
+		ResourcePtr<ParameterInt> mCount;				//< Property 'Count': optional line resolution, resizes the line mesh at run-time
+		ResourcePtr<SimulationClock> mSimulationClock;	//< Property 'SimulationClock': optional fixed rate clock that advances the smoothers and line clock
+		ResourcePtr<SmoothingEngine> mSmoothingEngine;	//< Property 'SmoothingEngine': optional engine shared by lines on the same clock, a private engine is used when empty
+		ResourcePtr<ParameterSnapshot> mParameterSnapshot;	//< Property 'ParameterSnapshot': optional snapshot of the modulation parameters, read lock free by the simulation clock thread
 		double mClockSpeed = 1.0;						//< Property 'ClockSpeed': speed multiplier
 		bool mReadback = false;							//< Property 'Readback' Whether to readback to host
 		bool mResetStorage = false;						//< Property 'ResetStorage': resets storage buffer to original
@@ -60,6 +102,9 @@ namespace nap
 	public:
 		ComputeLineComponentInstance(EntityInstance& entity, Component& resource);
 
+		// Destructor, detaches from the simulation clock
+		~ComputeLineComponentInstance() override;
+
 		/**
 		* Initializes this component
 		*/
@@ -83,8 +128,43 @@ namespace nap
 		LineMesh& getLineMesh() const { return *mLineMesh; }
 
 	protected:
+		/**
+		 * Updates the active vertex count of the line based on the laser point budget and line curvature
+		 */
+		void updateLOD();
+
+		/**
+		 * Advances the smoothers and line clock
+		 * @param time clock time at the end of the step in seconds
+		 * @param deltaTime time step in seconds
+		 * @return the new modulation values
+		 */
+		LineModulation advance(double time, double deltaTime);
+
+		/**
+		 * Sets the modulation uniforms of the compute material
+		 * @param modulation the values to set
+		 */
+		void setModulation(const LineModulation& modulation);
+
+		// Advances the line at a fixed rate on the simulation clock thread
+		class LineSimulation final : public Simulation
+		{
+		public:
+			LineSimulation(ComputeLineComponentInstance& line) : mLine(line) { }
+			void step(double time, double deltaTime) override;
+		private:
+			ComputeLineComponentInstance& mLine;
+		};
+
+		// Called when the line resolution parameter changes
+		void onCountChanged(int count)					{ mLineMesh->resize(static_cast<uint>(std::max(count, 2))); }
+		nap::Slot<int> mCountChangedSlot = { this, &ComputeLineComponentInstance::onCountChanged };
+
 		LineMesh* mLineMesh = nullptr;
 		NoiseProperties mProperties;
+		LineLODProperties mLOD;
+		std::vector<LaserOutputComponentInstance*> mLaserOutputs;
 
 		double mClockSpeed = 1.0;
 		double mElapsedClockTime = 0.0;
@@ -93,11 +173,21 @@ namespace nap
 		bool mReadback = false;
 		bool mResetStorage = false;
 
-		math::SmoothOperator<double> mWavelengthSmoother	{ 1.0, 0.1 };
-		math::SmoothOperator<double> mLinePosFreqSmoother	{ 1.0, 0.1 };
-		math::SmoothOperator<double> mAmplitudeSmoother		{ 1.0, 0.1 };
-		math::SmoothOperator<double> mSpeedSmoother			{ 0.0, 0.1 };
-		math::SmoothOperator<double> mOffsetSmoother		{ 0.0, 0.1 };
-		math::SmoothOperator<double> mShiftSmoother			{ 0.0, 0.1 };
+		// Smoothed modulation values, in order of the targets
+		SmoothingEngine* mSmoothingEngine = nullptr;
+		std::unique_ptr<SmoothingEngine> mPrivateSmoothingEngine;
+		std::array<SmoothingEngine::Handle, 5> mSmoothers;
+
+		// Fixed rate simulation, only when a clock is assigned
+		SimulationClock* mSimulationClock = nullptr;
+		LineSimulation mSimulation = { *this };
+		SnapshotBuffer<LineModulation> mSnapshots;
+		std::mutex mTargetMutex;
+		std::array<double, 5> mTargets;						///< Smoother targets written by the main thread: speed, wavelength, amplitude, offset, shift
+
+		// Consistent targets published after every frame, replaces the targets above when assigned
+		ParameterSnapshot* mParameterSnapshot = nullptr;
+		ParameterSnapshot::View mSnapshotView;				///< Owned by the thread that advances the line
+		std::array<int, 5> mSnapshotSlots;					///< Slot of every target in the snapshot
 	};
 }
@@ -0,0 +1,114 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+// Local Includes
+#include "gputimer.h"
+
+namespace nap
+{
+	GPUTimer::~GPUTimer()
+	{
+		if (mQueryPool == VK_NULL_HANDLE)
+			return;
+
+		// Queries might still be in use by frames in flight
+		mRenderService.queueVulkanObjectDestructor([pool = mQueryPool](RenderService& renderService)
+		{
+			vkDestroyQueryPool(renderService.getDevice(), pool, nullptr);
+		});
+	}
+
+
+	bool GPUTimer::init(uint scopeCount, utility::ErrorState& errorState)
+	{
+		// Without 'timestampComputeAndGraphics' only queues that report valid timestamp bits support timestamps
+		const auto& limits = mRenderService.getPhysicalDeviceProperties().limits;
+		uint32 family_count = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(mRenderService.getPhysicalDevice(), &family_count, nullptr);
+		std::vector<VkQueueFamilyProperties> families(family_count);
+		vkGetPhysicalDeviceQueueFamilyProperties(mRenderService.getPhysicalDevice(), &family_count, families.data());
+
+		uint32 queue_index = static_cast<uint32>(mRenderService.getQueueIndex());
+		uint32 valid_bits = queue_index < family_count ? families[queue_index].timestampValidBits : 0;
+		if (!errorState.check(limits.timestampPeriod > 0.0f && valid_bits > 0, "GPU timestamps not supported on queue family %d (timestampComputeAndGraphics: %s)",
+			queue_index, limits.timestampComputeAndGraphics == VK_TRUE ? "true" : "false"))
+			return false;
+
+		mTimestampPeriod = static_cast<double>(limits.timestampPeriod);
+		mTimestampMask = valid_bits >= 64 ? ~uint64(0) : (uint64(1) << valid_bits) - 1;
+
+		mScopeCount = scopeCount;
+		mFrameCount = static_cast<uint>(mRenderService.getMaxFramesInFlight());
+		mWritten.assign(mScopeCount * mFrameCount, false);
+		mMeasured.assign(mScopeCount, false);
+		mMilliseconds.assign(mScopeCount, 0.0);
+		if (mScopeCount == 0)
+			return true;
+
+		// Begin and end timestamp for every scope, for every frame in flight
+		VkQueryPoolCreateInfo pool_info = {};
+		pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		pool_info.queryCount = mScopeCount * mFrameCount * 2;
+		return errorState.check(vkCreateQueryPool(mRenderService.getDevice(), &pool_info, nullptr, &mQueryPool) == VK_SUCCESS,
+			"Failed to create timestamp query pool");
+	}
+
+
+	uint GPUTimer::getQuery(uint scope) const
+	{
+		return (static_cast<uint>(mRenderService.getCurrentFrameIndex()) * mScopeCount + scope) * 2;
+	}
+
+
+	void GPUTimer::begin(uint scope)
+	{
+		if (mQueryPool == VK_NULL_HANDLE || scope >= mScopeCount)
+			return;
+
+		VkCommandBuffer command_buffer = mRenderService.getCurrentCommandBuffer();
+		uint query = getQuery(scope);
+		vkCmdResetQueryPool(command_buffer, mQueryPool, query, 2);
+		vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, mQueryPool, query);
+	}
+
+
+	void GPUTimer::end(uint scope)
+	{
+		if (mQueryPool == VK_NULL_HANDLE || scope >= mScopeCount)
+			return;
+
+		uint query = getQuery(scope);
+		vkCmdWriteTimestamp(mRenderService.getCurrentCommandBuffer(), VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mQueryPool, query + 1);
+		mWritten[query / 2] = true;
+	}
+
+
+	void GPUTimer::resolve()
+	{
+		if (mQueryPool == VK_NULL_HANDLE)
+			return;
+
+		// The render service waited for the previous submission of this frame,
+		// scopes that didn't run in that frame (culled or disabled passes) have no result
+		for (uint scope = 0; scope < mScopeCount; scope++)
+		{
+			uint query = getQuery(scope);
+			mMeasured[scope] = false;
+			if (!mWritten[query / 2])
+				continue;
+
+			// Only the valid bits are written, the difference is taken modulo the valid range
+			uint64 timestamps[2] = { 0, 0 };
+			if (vkGetQueryPoolResults(mRenderService.getDevice(), mQueryPool, query, 2, sizeof(timestamps), timestamps,
+				sizeof(uint64), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+			{
+				uint64 ticks = (timestamps[1] - timestamps[0]) & mTimestampMask;
+				mMilliseconds[scope] = static_cast<double>(ticks) * mTimestampPeriod * 1.0e-6;
+				mMeasured[scope] = true;
+			}
+			mWritten[query / 2] = false;
+		}
+	}
+}
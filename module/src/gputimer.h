@@ -0,0 +1,83 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+// External includes
+#include <renderservice.h>
+#include <utility/errorstate.h>
+
+namespace nap
+{
+	/**
+	 * Measures GPU time of a fixed number of scopes using timestamp queries.
+	 *
+	 * Every frame in flight has its own set of queries. Results are read when the render service
+	 * reuses a frame, after it waited for that frame to complete: reading never stalls.
+	 * The reported time is therefore a few frames old.
+	 *
+	 * Call begin() and end() outside of a render pass, in between begin and end of a recording.
+	 * Call resolve() every frame after RenderService::beginFrame().
+	 */
+	class NAPAPI GPUTimer final
+	{
+	public:
+		// Constructor
+		GPUTimer(RenderService& renderService) : mRenderService(renderService) { }
+
+		// Destructor
+		~GPUTimer();
+
+		/**
+		 * Creates the query pool.
+		 * @param scopeCount number of timed scopes
+		 * @param errorState contains the error if timestamps are not supported
+		 * @return if initialization succeeded
+		 */
+		bool init(uint scopeCount, utility::ErrorState& errorState);
+
+		/**
+		 * Starts timing a scope in the current command buffer
+		 * @param scope index of the scope
+		 */
+		void begin(uint scope);
+
+		/**
+		 * Stops timing a scope in the current command buffer
+		 * @param scope index of the scope
+		 */
+		void end(uint scope);
+
+		/**
+		 * Reads the results of the frame that is about to be recorded
+		 */
+		void resolve();
+
+		/**
+		 * @param scope index of the scope
+		 * @return GPU time of the scope in the last resolved frame in milliseconds, 0 if the scope didn't run in that frame
+		 */
+		double getMilliseconds(uint scope) const				{ return isMeasured(scope) ? mMilliseconds[scope] : 0.0; }
+
+		/**
+		 * @param scope index of the scope
+		 * @return if the scope ran in the last resolved frame
+		 */
+		bool isMeasured(uint scope) const						{ return scope < mMeasured.size() && mMeasured[scope]; }
+
+	private:
+		// Returns the first query of a scope in the current frame
+		uint getQuery(uint scope) const;
+
+		RenderService& mRenderService;
+		VkQueryPool mQueryPool = VK_NULL_HANDLE;
+		uint mScopeCount = 0;
+		uint mFrameCount = 0;
+		double mTimestampPeriod = 0.0;							///< Nanoseconds per timestamp tick
+		uint64 mTimestampMask = 0;								///< Valid bits of a timestamp
+		std::vector<bool> mWritten;								///< Written scopes, per frame
+		std::vector<bool> mMeasured;							///< If the scope ran in the last resolved frame
+		std::vector<double> mMilliseconds;						///< Last result per scope
+	};
+}
@@ -90,6 +90,15 @@ namespace nap
 
 	void LaserOutputComponentInstance::update(double deltaTime)
 	{
+		// Measure the point rate over a window of a second
+		mPointWindow += deltaTime;
+		if (mPointWindow >= 1.0)
+		{
+			mPointsPerSecond = static_cast<float>(static_cast<double>(mPointCount) / mPointWindow);
+			mPointCount = 0;
+			mPointWindow = 0.0;
+		}
+
 		if (!mEnabled)
 			return;
 
@@ -99,6 +108,20 @@ namespace nap
 
 		// Send the polyline to the dac based on the location of the laser and the location of the line
 		populateLaserBuffer(*mLineMesh, mLineTransform->getGlobalTransform());
+		mPointCount += mPoints.size();
+	}
+
+
+	int LaserOutputComponentInstance::getPointsPerFrame() const
+	{
+		return static_cast<int>(static_cast<float>(mDac->mPointRate) / static_cast<float>(mProperties.mFrameRate));
+	}
+
+
+	float LaserOutputComponentInstance::getFrameFill() const
+	{
+		int points_per_frame = getPointsPerFrame();
+		return points_per_frame > 0 ? static_cast<float>(mPoints.size()) / static_cast<float>(points_per_frame) : 0.0f;
 	}
 
 
@@ -116,7 +139,7 @@ namespace nap
 		assert(verts.size() > 1);
 
 		// Get the total amount of points per frame that this laser is allowed to draw and resize buffer
-		int ppf = static_cast<int>(static_cast<float>(mDac->mPointRate) / static_cast<float>(mProperties.mFrameRate));
+		int ppf = getPointsPerFrame();
 		mVerts.resize(ppf);
 		mColors.resize(ppf);
 
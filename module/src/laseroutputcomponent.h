@@ -94,6 +94,21 @@ namespace nap
 		// Sets the dac to send to the laser
 		void setDac(EtherDreamDac& dac)					{ mDac = &dac; }
 
+		// Returns the line that is sent to the laser
+		const LineMesh& getLineMesh() const				{ return *mLineMesh; }
+
+		// Returns if this output is sending points to the laser
+		bool isEnabled() const							{ return mEnabled; }
+
+		// Returns the number of points a single laser frame holds: point rate / frame rate
+		int getPointsPerFrame() const;
+
+		// Returns the number of points sent to the DAC per second, measured over the last second
+		float getPointsPerSecond() const				{ return mPointsPerSecond; }
+
+		// Returns the number of points of the last frame relative to the points a laser frame holds
+		float getFrameFill() const;
+
 	private:
 		// Populate Laser Buffer
 		void populateLaserBuffer(const LineMesh& line, const glm::mat4x4& lineXform);
@@ -113,5 +128,10 @@ namespace nap
 		std::vector<glm::vec4> mColors;						//< Converted vertex colors
 
 		bool mEnabled = true;
+
+		// Point rate measurement
+		uint64 mPointCount = 0;								//< Points sent in the current window
+		double mPointWindow = 0.0;							//< Elapsed time of the current window in seconds
+		float mPointsPerSecond = 0.0f;						//< Points sent per second in the last window
 	};
 }
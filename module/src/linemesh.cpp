@@ -25,6 +25,27 @@ namespace nap
 	}
 
 
+	// Linearly resamples src to count elements, returns src when the element count matches
+	template<typename T>
+	static std::vector<T> resample(const std::vector<T>& src, uint count)
+	{
+		if (src.size() == count || src.size() < 2)
+			return src;
+
+		std::vector<T> dst;
+		dst.reserve(count);
+		const float scale = static_cast<float>(src.size() - 1) / static_cast<float>(std::max<uint>(count - 1, 1));
+		for (uint i = 0; i < count; i++)
+		{
+			const float idx = static_cast<float>(i) * scale;
+			const uint i0 = std::min<uint>(static_cast<uint>(idx), src.size() - 1);
+			const uint i1 = std::min<uint>(i0 + 1, src.size() - 1);
+			dst.emplace_back(glm::mix(src[i0], src[i1], idx - static_cast<float>(i0)));
+		}
+		return dst;
+	}
+
+
 	static uint swapBufferIndex(uint index)
 	{
 		return (index + 1) % 2;
@@ -35,25 +56,61 @@ namespace nap
 	 * LineMesh
 	 */
 	LineMesh::LineMesh(Core& core) :
-		mRenderService(*core.getService<RenderService>()),
-		mPositionBuffer({std::make_unique<VertexBufferVec4>(core), std::make_unique<VertexBufferVec4>(core), std::make_unique<VertexBufferVec4>(core), std::make_unique<VertexBufferVec4>(core)}),
-		mNormalBuffer({std::make_unique<VertexBufferVec4>(core), std::make_unique<VertexBufferVec4>(core), std::make_unique<VertexBufferVec4>(core), std::make_unique<VertexBufferVec4>(core)}),
-		mUVBuffer({std::make_unique<VertexBufferVec4>(core), std::make_unique<VertexBufferVec4>(core), std::make_unique<VertexBufferVec4>(core), std::make_unique<VertexBufferVec4>(core)}),
-		mColorBuffer({std::make_unique<VertexBufferVec4>(core), std::make_unique<VertexBufferVec4>(core), std::make_unique<VertexBufferVec4>(core), std::make_unique<VertexBufferVec4>(core)})
+		mCore(core),
+		mRenderService(*core.getService<RenderService>())
 	{ }
 
 
 	bool LineMesh::init(utility::ErrorState& errorState)
 	{
 		const uint count = mPolyLine->getMeshInstance().getNumVertices();
+		mActiveCount = mCount > 0 ? std::clamp<uint>(mCount, std::min<uint>(count, 2), count) : count;
+		mResolution = mActiveCount;
+
+		// Create resources, all ranks that can be read from hold the line initially
+		if (!allocate(count, { 0, 1, ORIGINAL_BUFFER_INDEX }, errorState))
+			return false;
+
+		// Create mesh instance
+		mMeshInstance = std::make_unique<MeshInstance>(mRenderService);
+		mMeshInstance->setNumVertices(std::max<int>(count, 2));
+		mMeshInstance->setUsage(mUsage);
+		mMeshInstance->setDrawMode(EDrawMode::LineStrip);
+		mMeshInstance->setPolygonMode(EPolygonMode::Line);
+		mMeshInstance->setCullMode(ECullMode::None);
+
+		// Attributes
+		const std::vector position_buffer(count, glm::zero<glm::vec4>());
+		mMeshInstance->getOrCreateAttribute<glm::vec4>(vertexid::position).setData(position_buffer);
+
+		const std::vector normal_buffer(count, glm::zero<glm::vec4>());
+		mMeshInstance->getOrCreateAttribute<glm::vec4>(vertexid::normal).setData(normal_buffer);
+
+		const std::vector uv_buffer(count, glm::zero<glm::vec4>());
+		mMeshInstance->getOrCreateAttribute<glm::vec4>(vertexid::getUVName(0)).setData(uv_buffer);
+
+		const std::vector color_buffer(count, glm::one<glm::vec4>());
+		mMeshInstance->getOrCreateAttribute<glm::vec4>(vertexid::getColorName(0)).setData(color_buffer);
+
+		auto& poly = mPolyLine->getMeshInstance();
+		auto& shape = mMeshInstance->createShape();
+		shape.setIndices(poly.getShape(0).getIndices().data(), poly.getShape(0).getNumIndices());
+
+		return mMeshInstance->init(errorState);
+	}
 
+
+	bool LineMesh::allocate(uint capacity, const std::vector<uint>& uploadIndices, utility::ErrorState& errorState)
+	{
 		// Create resources
-		const std::vector buffers = { &mPositionBuffer, &mNormalBuffer, &mUVBuffer, &mColorBuffer };
-		for (const auto* quad_buffer : buffers)
+		VertexQuadrupleBufferVec4 position_buffer, normal_buffer, uv_buffer, color_buffer;
+		const std::vector buffers = { &position_buffer, &normal_buffer, &uv_buffer, &color_buffer };
+		for (auto* quad_buffer : buffers)
 		{
 			for (uint i = 0; i < QUAD_BUFFER_COUNT; i++)
 			{
 				auto& buf = (*quad_buffer)[i];
+				buf = std::make_unique<VertexBufferVec4>(mCore);
 				switch (static_cast<EBufferRank>(i))
 				{
 					case EBufferRank::Original:
@@ -68,60 +125,73 @@ namespace nap
 						buf->mMemoryUsage = EMemoryUsage::Static;
 						buf->mClear = true;
 				}
-				buf->mCount = count;
+				buf->mCount = capacity;
 				if (!buf->init(errorState))
 					return false;
 			}
 		}
 
-		// Create mesh instance
-		mMeshInstance = std::make_unique<MeshInstance>(mRenderService);
-		mMeshInstance->setNumVertices(std::max<int>(count, 2));
-		mMeshInstance->setUsage(mUsage);
-		mMeshInstance->setDrawMode(EDrawMode::LineStrip);
-		mMeshInstance->setPolygonMode(EPolygonMode::Line);
-		mMeshInstance->setCullMode(ECullMode::None);
-
-		// Upload initial data for all vertex buffers from the line attributes
+		// Upload line attributes, resampled to the requested capacity
 		auto& poly = mPolyLine->getMeshInstance();
-		const auto& pos_attr = poly.getOrCreateAttribute<glm::vec3>(vertexid::position);
-		const auto& nor_attr = poly.getOrCreateAttribute<glm::vec3>(vertexid::normal);
-		const auto& uv_attr = poly.getOrCreateAttribute<glm::vec3>(vertexid::uv);
-		const auto& col_attr = poly.getOrCreateAttribute<glm::vec4>(vertexid::color);
+		const auto positions = resample(poly.getOrCreateAttribute<glm::vec3>(vertexid::position).getData(), capacity);
+		const auto normals = resample(poly.getOrCreateAttribute<glm::vec3>(vertexid::normal).getData(), capacity);
+		const auto uvs = resample(poly.getOrCreateAttribute<glm::vec3>(vertexid::uv).getData(), capacity);
+		const auto colors = resample(poly.getOrCreateAttribute<glm::vec4>(vertexid::color).getData(), capacity);
 
-		const std::vector<uint> copy_indices = { 0, 1, ORIGINAL_BUFFER_INDEX };
-		for (const uint i : copy_indices)
+		for (const uint i : uploadIndices)
 		{
-			if (!uploadVec3ToVec4(pos_attr.getData(), *mPositionBuffer[i], 1.0f, errorState))
+			if (!uploadVec3ToVec4(positions, *position_buffer[i], 1.0f, errorState))
 				return false;
 
-			if (!uploadVec3ToVec4(nor_attr.getData(), *mNormalBuffer[i], 0.0f, errorState))
+			if (!uploadVec3ToVec4(normals, *normal_buffer[i], 0.0f, errorState))
 				return false;
 
-			if (!uploadVec3ToVec4(uv_attr.getData(), *mUVBuffer[i], 0.0f, errorState))
+			if (!uploadVec3ToVec4(uvs, *uv_buffer[i], 0.0f, errorState))
 				return false;
 
-			if (!mColorBuffer[i]->setData(col_attr.getData(), errorState))
+			if (!color_buffer[i]->setData(colors, errorState))
 				return false;
 		}
 
-		// Attributes
-		const std::vector position_buffer(count, glm::zero<glm::vec4>());
-		mMeshInstance->getOrCreateAttribute<glm::vec4>(vertexid::position).setData(position_buffer);
+		// Replace buffers, destruction of the previous buffers is deferred by the render service until the GPU is done with them
+		mPositionBuffer = std::move(position_buffer);
+		mNormalBuffer = std::move(normal_buffer);
+		mUVBuffer = std::move(uv_buffer);
+		mColorBuffer = std::move(color_buffer);
+		mCapacity = capacity;
+		return true;
+	}
 
-		const std::vector normal_buffer(count, glm::zero<glm::vec4>());
-		mMeshInstance->getOrCreateAttribute<glm::vec4>(vertexid::normal).setData(normal_buffer);
 
-		const std::vector uv_buffer(count, glm::zero<glm::vec4>());
-		mMeshInstance->getOrCreateAttribute<glm::vec4>(vertexid::getUVName(0)).setData(uv_buffer);
+	void LineMesh::resize(uint count)
+	{
+		mPendingResolution = std::max<uint>(count, 2);
+	}
 
-		const std::vector color_buffer(count, glm::one<glm::vec4>());
-		mMeshInstance->getOrCreateAttribute<glm::vec4>(vertexid::getColorName(0)).setData(color_buffer);
 
-		auto& shape = mMeshInstance->createShape();
-		shape.setIndices(poly.getShape(0).getIndices().data(), poly.getShape(0).getNumIndices());
+	bool LineMesh::applyResize(utility::ErrorState& errorState)
+	{
+		if (mPendingResolution == 0)
+			return true;
 
-		return mMeshInstance->init(errorState);
+		const uint resolution = mPendingResolution;
+		mPendingResolution = 0;
+		if (resolution > mCapacity)
+		{
+			// Grow geometrically to keep reallocations rare when the resolution is increased in small steps.
+			// The next compute pass resets to the original buffer, only that rank requires an upload.
+			uint capacity = std::max<uint>(mCapacity, 2);
+			while (capacity < resolution)
+				capacity *= 2;
+
+			if (!allocate(capacity, { ORIGINAL_BUFFER_INDEX }, errorState))
+				return false;
+			reset();
+		}
+
+		mResolution = resolution;
+		setActiveCount(resolution);
+		return true;
 	}
 
 
@@ -129,12 +199,12 @@ namespace nap
 	{
 		// Copy to readback
 		assert(mRenderService.getCurrentCommandBuffer() != VK_NULL_HANDLE);
-		const VkBufferCopy region = { 0, 0, mCount*sizeof(glm::vec4) };
+		const VkBufferCopy region = { 0, 0, mActiveCount*sizeof(glm::vec4) };
 		vkCmdCopyBuffer(mRenderService.getCurrentCommandBuffer(), getPositionBuffer(EBufferRank::Read).getBuffer(), getPositionBuffer(EBufferRank::Readback).getBuffer(), 1, &region);
 		vkCmdCopyBuffer(mRenderService.getCurrentCommandBuffer(), getColorBuffer(EBufferRank::Read).getBuffer(), getColorBuffer(EBufferRank::Readback).getBuffer(), 1, &region);
 
 		// Queue download
-		getPositionBuffer(EBufferRank::Readback).asyncGetData([this, count = mCount](const void *data, size_t size)
+		getPositionBuffer(EBufferRank::Readback).asyncGetData([this, count = mActiveCount](const void *data, size_t size)
 		{
 			const size_t copy_bytes = count*sizeof(glm::vec4); assert(copy_bytes <= size);
 			mPositionsLocal.resize(count);
@@ -142,7 +212,7 @@ namespace nap
 		});
 
 		// Queue download
-		getColorBuffer(EBufferRank::Readback).asyncGetData([this, count = mCount](const void *data, size_t size)
+		getColorBuffer(EBufferRank::Readback).asyncGetData([this, count = mActiveCount](const void *data, size_t size)
 		{
 			const size_t copy_bytes = count*sizeof(glm::vec4); assert(copy_bytes <= size);
 			mColorsLocal.resize(count);
@@ -160,6 +230,18 @@ namespace nap
 	}
 
 
+	void LineMesh::setActiveCount(uint count)
+	{
+		const uint clamped = std::clamp<uint>(count, std::min<uint>(mResolution, 2), mResolution);
+		if (clamped == mActiveCount)
+			return;
+
+		// Previous output was written in the old layout, start over from the original line
+		mActiveCount = clamped;
+		reset();
+	}
+
+
 	VertexBufferVec4& LineMesh::getPositionBuffer(EBufferRank rank) const
 	{
 		return *mPositionBuffer[getBufferIndex(rank, mPositionBufferIndex, mResetPositions)];
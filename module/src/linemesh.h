@@ -30,7 +30,7 @@ namespace nap
 
 		ResourcePtr<PolyLine> mPolyLine;						///<
 		EMemoryUsage mUsage = EMemoryUsage::Static;				///< Property: 'Usage' If the line is created once or frequently updated.
-		uint mCount = 2;										///< Property: 'Count' The vertex attribute element count.
+		uint mCount = 0;										///< Property: 'Count' Initial number of active vertices, 0 to use all vertices of the line.
 
 		/**
 		 * Double-buffer
@@ -77,6 +77,43 @@ namespace nap
 		 */
 		void reset();
 
+		/**
+		 * @return the number of vertices the GPU buffers are allocated for
+		 */
+		uint getCapacity() const										{ return mCapacity; }
+
+		/**
+		 * @return the number of vertices that are computed, read back and drawn
+		 */
+		uint getActiveCount() const										{ return mActiveCount; }
+
+		/**
+		 * @return the requested number of vertices of the line, the upper bound of the active vertex count
+		 */
+		uint getResolution() const										{ return mResolution; }
+
+		/**
+		 * Sets the number of vertices that are computed, read back and drawn, clamped to [2, resolution].
+		 * The GPU buffers are not reallocated, the compute shader resamples the original line into the active range.
+		 * @param count the new active vertex count
+		 */
+		void setActiveCount(uint count);
+
+		/**
+		 * Requests a new line resolution, applied on the next frame boundary by applyResize().
+		 * Buffers are only reallocated when the resolution exceeds the capacity, which then grows geometrically.
+		 * @param count the requested number of vertices
+		 */
+		void resize(uint count);
+
+		/**
+		 * Applies a pending resize request. Call this once per frame before compute and render commands are recorded.
+		 * Buffers that are replaced are destroyed by the render service once the GPU no longer uses them.
+		 * @param errorState contains the error if the buffers could not be reallocated
+		 * @return if the pending resize was applied
+		 */
+		bool applyResize(utility::ErrorState& errorState);
+
 		/**
 		 * Readback buffer.
 		 */
@@ -90,6 +127,9 @@ namespace nap
 		using VertexQuadrupleBufferVec4 = std::array<std::unique_ptr<VertexBufferVec4>, QUAD_BUFFER_COUNT>;
 		uint getBufferIndex(EBufferRank rank, uint index, bool reset) const;
 
+		// (Re)creates all buffers for the given capacity and uploads the line to the given buffer indices
+		bool allocate(uint capacity, const std::vector<uint>& uploadIndices, utility::ErrorState& errorState);
+
 		VertexQuadrupleBufferVec4 mPositionBuffer;
 		VertexQuadrupleBufferVec4 mNormalBuffer;
 		VertexQuadrupleBufferVec4 mUVBuffer;
@@ -99,12 +139,17 @@ namespace nap
 		std::vector<glm::vec4> mColorsLocal;
 
 		std::unique_ptr<MeshInstance> mMeshInstance = nullptr;	///< The mesh instance to construct
+		Core& mCore;											///< Handle to core, used to create buffers
 		RenderService& mRenderService;							///< Handle to the render service
 
 		uint mPositionBufferIndex = 0;							///< Buffer index
 		uint mNormalBufferIndex = 0;							///< Buffer index
 		uint mUVBufferIndex = 0;								///< Buffer index
 		uint mColorBufferIndex = 0;								///< Buffer index
+		uint mCapacity = 0;										///< Number of allocated vertices
+		uint mActiveCount = 0;									///< Number of active vertices
+		uint mResolution = 0;									///< Requested number of vertices
+		uint mPendingResolution = 0;							///< Resolution to apply on the next frame, 0 when none
 
 		bool mResetPositions = false;							///< Whether reset is enabled
 		bool mResetNormals = false;								///< Whether reset is enabled
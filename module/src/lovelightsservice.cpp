@@ -2,11 +2,13 @@
 #include "lovelightsservice.h"
 #include "parameterwindow.h"
 #include "infowindow.h"
+#include "parametersnapshot.h"
 
 // External Includes
 #include <parameterguiservice.h>
 #include <appguiservice.h>
 #include <nap/core.h>
+#include <algorithm>
 
 RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::LoveLightsService)
 	RTTI_CONSTRUCTOR(nap::ServiceConfiguration*)
@@ -34,5 +36,25 @@ namespace nap
         auto* appgui_service = getCore().getService<AppGUIService>();
         factory.addObjectCreator(std::make_unique<InfoWindowObjectCreator>(*appgui_service));
         factory.addObjectCreator(std::make_unique<ParameterWindowObjectCreator>(*appgui_service));
+        factory.addObjectCreator(std::make_unique<ParameterSnapshotObjectCreator>(*this));
     }
+
+
+	void LoveLightsService::postUpdate(double deltaTime)
+	{
+		for (auto* snapshot : mSnapshots)
+			snapshot->publish();
+	}
+
+
+	void LoveLightsService::registerSnapshot(ParameterSnapshot& snapshot)
+	{
+		mSnapshots.emplace_back(&snapshot);
+	}
+
+
+	void LoveLightsService::unregisterSnapshot(ParameterSnapshot& snapshot)
+	{
+		mSnapshots.erase(std::remove(mSnapshots.begin(), mSnapshots.end(), &snapshot), mSnapshots.end());
+	}
 }
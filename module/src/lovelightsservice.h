@@ -6,6 +6,9 @@
 
 namespace nap
 {
+	// Forward declares
+	class ParameterSnapshot;
+
 	class NAPAPI LoveLightsService : public Service
 	{
 		RTTI_ENABLE(Service)
@@ -28,7 +31,26 @@ namespace nap
 		 */
 		virtual bool init(nap::utility::ErrorState& errorState) override;
 
+		/**
+		 * Publishes all parameter snapshots, after the app changed parameters
+		 * @param deltaTime time in between frames in seconds
+		 */
+		virtual void postUpdate(double deltaTime) override;
+
+		/**
+		 * Publishes the snapshot after every update, called by the snapshot on init
+		 */
+		void registerSnapshot(ParameterSnapshot& snapshot);
+
+		/**
+		 * Stops publishing the snapshot, called by the snapshot on destruction
+		 */
+		void unregisterSnapshot(ParameterSnapshot& snapshot);
+
     protected:
         void registerObjectCreators(rtti::Factory &factory) override;
+
+	private:
+		std::vector<ParameterSnapshot*> mSnapshots;
 	};
 }
@@ -0,0 +1,274 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+// Local Includes
+#include "oscbundlereceiver.h"
+
+// External Includes
+#include <nap/logger.h>
+#include <osc/OscException.h>
+#include <osc/OscPacketListener.h>
+#include <osc/OscReceivedElements.h>
+#include <ip/UdpSocket.h>
+#include <algorithm>
+
+RTTI_BEGIN_CLASS(nap::OSCBundleReceiver)
+	RTTI_PROPERTY("Port",				&nap::OSCBundleReceiver::mPort,				nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("Latency",			&nap::OSCBundleReceiver::mLatency,			nap::rtti::EPropertyMetaData::Default)
+RTTI_END_CLASS
+
+namespace nap
+{
+	// Offset samples are kept for two windows of this length in seconds
+	static constexpr double sOffsetWindow = 5.0;
+
+	// Timetag that marks a bundle to be processed immediately
+	static constexpr uint64 sImmediate = 1;
+
+
+	// Heap order, the earliest message is released first
+	static bool isLater(const OSCBundleReceiver::Scheduled& a, const OSCBundleReceiver::Scheduled& b)
+	{
+		return a.mTime != b.mTime ? a.mTime > b.mTime : a.mSequence > b.mSequence;
+	}
+
+
+	/**
+	 * Converts an oscpack message into a nap::OSCEvent, unsupported argument types are skipped
+	 */
+	static OSCEventPtr toEvent(const osc::ReceivedMessage& message)
+	{
+		auto event = std::make_unique<OSCEvent>(message.AddressPattern());
+		for (auto arg = message.ArgumentsBegin(); arg != message.ArgumentsEnd(); ++arg)
+		{
+			if (arg->IsFloat())
+				event->addValue<float>(arg->AsFloatUnchecked());
+			else if (arg->IsInt32())
+				event->addValue<int>(arg->AsInt32Unchecked());
+			else if (arg->IsDouble())
+				event->addValue<double>(arg->AsDoubleUnchecked());
+			else if (arg->IsBool())
+				event->addValue<bool>(arg->AsBoolUnchecked());
+			else if (arg->IsString())
+				event->addString(arg->AsStringUnchecked());
+			else if (arg->IsBlob())
+			{
+				const void* data = nullptr;
+				osc::osc_bundle_element_size_t size = 0;
+				arg->AsBlobUnchecked(data, size);
+				event->addBlob(data, static_cast<int>(size));
+			}
+		}
+		return event;
+	}
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// Listener
+	//////////////////////////////////////////////////////////////////////////
+
+	/**
+	 * Schedules the messages of incoming packets, called from the receive thread
+	 */
+	class OSCBundleReceiver::Listener : public osc::OscPacketListener
+	{
+	public:
+		Listener(OSCBundleReceiver& receiver) : mReceiver(receiver) { }
+
+	protected:
+		void ProcessPacket(const char* data, int size, const IpEndpointName& remoteEndpoint) override
+		{
+			// oscpack throws on malformed packets, uncaught that terminates the receive thread.
+			// The messages of a packet are collected first, nothing of a malformed packet is scheduled.
+			double arrival = mReceiver.getTime();
+			try
+			{
+				osc::OscPacketListener::ProcessPacket(data, size, remoteEndpoint);
+			}
+			catch (const osc::Exception& exception)
+			{
+				nap::Logger::warn("%s: dropped malformed packet: %s", mReceiver.mID.c_str(), exception.what());
+				mPending.clear();
+				return;
+			}
+			mReceiver.schedule(mPending, arrival);
+		}
+
+		void ProcessMessage(const osc::ReceivedMessage& message, const IpEndpointName& remoteEndpoint) override
+		{
+			mPending.push_back({ mReceiver.getTime(), 0, toEvent(message) });
+		}
+
+		void ProcessBundle(const osc::ReceivedBundle& bundle, const IpEndpointName& remoteEndpoint) override
+		{
+			// All messages of the bundle share the release time, nested bundles are scheduled by their own timetag
+			double time = mReceiver.getReleaseTime(bundle.TimeTag());
+			for (auto element = bundle.ElementsBegin(); element != bundle.ElementsEnd(); ++element)
+			{
+				if (element->IsBundle())
+					ProcessBundle(osc::ReceivedBundle(*element), remoteEndpoint);
+				else
+					mPending.push_back({ time, 0, toEvent(osc::ReceivedMessage(*element)) });
+			}
+		}
+
+	private:
+		OSCBundleReceiver& mReceiver;
+		std::vector<Scheduled> mPending;				///< Messages of the packet being processed
+	};
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// OSCBundleReceiver
+	//////////////////////////////////////////////////////////////////////////
+
+	OSCBundleReceiver::OSCBundleReceiver() = default;
+
+
+	OSCBundleReceiver::~OSCBundleReceiver() = default;
+
+
+	bool OSCBundleReceiver::init(utility::ErrorState& errorState)
+	{
+		return errorState.check(mLatency >= 0.0f, "%s: 'Latency' can't be negative", mID.c_str());
+	}
+
+
+	bool OSCBundleReceiver::start(utility::ErrorState& errorState)
+	{
+		mStartTime = std::chrono::steady_clock::now();
+		mHasOffset = false;
+		mQueue.clear();
+		mArrivals.clear();
+		mListener = std::make_unique<Listener>(*this);
+
+		try
+		{
+			mSocket = std::make_unique<UdpListeningReceiveSocket>(IpEndpointName(IpEndpointName::ANY_ADDRESS, mPort), mListener.get());
+		}
+		catch (const std::runtime_error& exception)
+		{
+			errorState.fail("%s: unable to open port %d: %s", mID.c_str(), mPort, exception.what());
+			mListener.reset();
+			return false;
+		}
+
+		mThread = std::thread([this] { mSocket->Run(); });
+		nap::Logger::info("%s: listening for bundles on port %d", mID.c_str(), mPort);
+		return true;
+	}
+
+
+	void OSCBundleReceiver::stop()
+	{
+		if (mSocket == nullptr)
+			return;
+
+		mSocket->AsynchronousBreak();
+		if (mThread.joinable())
+			mThread.join();
+		mSocket.reset();
+		mListener.reset();
+	}
+
+
+	double OSCBundleReceiver::getTime() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - mStartTime).count();
+	}
+
+
+	double OSCBundleReceiver::getClockOffset() const
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		return std::min(mWindowMin, mPreviousMin);
+	}
+
+
+	double OSCBundleReceiver::getReleaseTime(uint64 timeTag)
+	{
+		double arrival = getTime();
+		if (timeTag == sImmediate)
+			return arrival;
+
+		// NTP 32.32 fixed point seconds
+		double sender = static_cast<double>(timeTag >> 32) + static_cast<double>(timeTag & 0xffffffffu) / 4294967296.0;
+		double sample = arrival - sender;
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (!mHasOffset)
+		{
+			mWindowStart = arrival;
+			mWindowMin = mPreviousMin = sample;
+			mHasOffset = true;
+		}
+		else if (arrival - mWindowStart > sOffsetWindow)
+		{
+			// Forget old samples, allows the estimate to follow clock drift
+			mPreviousMin = mWindowMin;
+			mWindowMin = sample;
+			mWindowStart = arrival;
+		}
+		else
+		{
+			mWindowMin = std::min(mWindowMin, sample);
+		}
+
+		double release = sender + std::min(mWindowMin, mPreviousMin) + static_cast<double>(mLatency);
+		if (release < arrival)
+		{
+			mLateCount.fetch_add(1, std::memory_order_relaxed);
+			return arrival;
+		}
+		return release;
+	}
+
+
+	void OSCBundleReceiver::schedule(std::vector<Scheduled>& messages, double arrival)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		for (auto& message : messages)
+		{
+			message.mSequence = mSequence++;
+			if (std::find(mStampedAddresses.begin(), mStampedAddresses.end(), message.mEvent->getAddress()) != mStampedAddresses.end())
+			{
+				message.mTime = arrival;
+				mArrivals.emplace_back(std::move(message));
+				continue;
+			}
+			mQueue.emplace_back(std::move(message));
+			std::push_heap(mQueue.begin(), mQueue.end(), isLater);
+		}
+		messages.clear();
+	}
+
+
+	void OSCBundleReceiver::popDue(double time, std::vector<OSCEventPtr>& events)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		while (!mQueue.empty() && mQueue.front().mTime <= time)
+		{
+			std::pop_heap(mQueue.begin(), mQueue.end(), isLater);
+			events.emplace_back(std::move(mQueue.back().mEvent));
+			mQueue.pop_back();
+		}
+	}
+
+
+	void OSCBundleReceiver::addStampedAddress(const std::string& address)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (std::find(mStampedAddresses.begin(), mStampedAddresses.end(), address) == mStampedAddresses.end())
+			mStampedAddresses.emplace_back(address);
+	}
+
+
+	void OSCBundleReceiver::popArrivals(std::vector<Scheduled>& arrivals)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		for (auto& arrival : mArrivals)
+			arrivals.emplace_back(std::move(arrival));
+		mArrivals.clear();
+	}
+}
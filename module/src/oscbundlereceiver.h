@@ -0,0 +1,140 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+// External includes
+#include <nap/device.h>
+#include <oscevent.h>
+#include <utility/dllexport.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Forward declares
+class UdpListeningReceiveSocket;
+
+namespace nap
+{
+	/**
+	 * Receives OSC bundles and schedules their messages by timetag.
+	 *
+	 * The nap::OSCReceiver dispatches the messages of a bundle as soon as they arrive and discards the timetag,
+	 * network jitter therefore shows up as timing jitter. This receiver keeps every message in a time ordered
+	 * queue until it is due. Messages of the same bundle share a release time and are released in the same frame.
+	 *
+	 * The clock offset to the sender is estimated from the stream: the smallest difference between arrival time
+	 * and timetag over the last few seconds, which is the bundle that arrived with the least delay. A message is
+	 * released 'Latency' seconds after its timetag, mapped to the local clock. Jitter below the latency is absorbed,
+	 * the relative timing of cues is preserved. Messages outside of a bundle, or with the immediate timetag,
+	 * are released right away.
+	 *
+	 * Call popDue() every frame to collect the released messages.
+	 *
+	 * Messages at a stamped address, see addStampedAddress(), aren't scheduled. They keep the time they arrived at,
+	 * taken on the receive thread, and are collected with popArrivals(). Used for beats, where the arrival is the event.
+	 */
+	class NAPAPI OSCBundleReceiver : public Device
+	{
+		RTTI_ENABLE(Device)
+	public:
+		int mPort = 7001;										///< Property: 'Port' UDP port to listen on
+		float mLatency = 0.02f;									///< Property: 'Latency' seconds added to every timetag to absorb network jitter
+
+		/**
+		 * Message waiting for its release time, or a stamped message and its arrival time
+		 */
+		struct Scheduled
+		{
+			double mTime = 0.0;									///< Local release time, arrival time of a stamped message, in seconds
+			uint64 mSequence = 0;								///< Keeps arrival order of messages with the same time
+			OSCEventPtr mEvent;
+		};
+
+		// Constructor
+		OSCBundleReceiver();
+
+		// Destructor
+		virtual ~OSCBundleReceiver();
+
+		/**
+		 * Validates the latency
+		 */
+		bool init(utility::ErrorState& errorState) override;
+
+		/**
+		 * Opens the socket and starts receiving
+		 */
+		bool start(utility::ErrorState& errorState) override;
+
+		/**
+		 * Stops receiving and closes the socket
+		 */
+		void stop() override;
+
+		/**
+		 * Moves all messages that are due at the given time into events, in order of release time. Thread safe.
+		 * @param time local time in seconds, see getTime()
+		 * @param events receives the due messages, appended
+		 */
+		void popDue(double time, std::vector<OSCEventPtr>& events);
+
+		/**
+		 * Messages at the address are no longer scheduled, they are kept with their arrival time. Thread safe.
+		 * @param address OSC address to stamp
+		 */
+		void addStampedAddress(const std::string& address);
+
+		/**
+		 * Moves all messages that arrived at a stamped address into arrivals, in order of arrival. Thread safe.
+		 * @param arrivals receives the messages, appended, the time is the local arrival time in seconds
+		 */
+		void popArrivals(std::vector<Scheduled>& arrivals);
+
+		/**
+		 * @return local time in seconds since start
+		 */
+		double getTime() const;
+
+		/**
+		 * @return estimated local minus sender clock in seconds, including the smallest network delay
+		 */
+		double getClockOffset() const;
+
+		/**
+		 * @return number of messages that arrived after their release time and were released right away
+		 */
+		uint64 getLateCount() const								{ return mLateCount.load(std::memory_order_relaxed); }
+
+	private:
+		class Listener;
+		friend class Listener;
+
+		// Returns the local release time of a timetag, updates the clock offset estimate
+		double getReleaseTime(uint64 timeTag);
+
+		// Adds the messages of a packet to the queue under one lock, popDue() never releases part of a bundle. Clears messages.
+		void schedule(std::vector<Scheduled>& messages, double arrival);
+
+		std::unique_ptr<Listener> mListener;
+		std::unique_ptr<UdpListeningReceiveSocket> mSocket;
+		std::thread mThread;
+
+		mutable std::mutex mMutex;
+		std::vector<Scheduled> mQueue;							///< Min heap on release time
+		std::vector<Scheduled> mArrivals;						///< Stamped messages in order of arrival
+		std::vector<std::string> mStampedAddresses;
+		uint64 mSequence = 0;
+		double mWindowStart = 0.0;								///< Start of the current offset window
+		double mWindowMin = 0.0;								///< Smallest offset sample in the current window
+		double mPreviousMin = 0.0;								///< Smallest offset sample in the previous window
+		bool mHasOffset = false;
+		std::atomic<uint64> mLateCount = { 0 };
+		std::chrono::steady_clock::time_point mStartTime;
+	};
+}
@@ -0,0 +1,494 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+// Local Includes
+#include "osccapturecomponent.h"
+
+// External Includes
+#include <entity.h>
+#include <oscinputcomponent.h>
+#include <nap/logger.h>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+RTTI_BEGIN_ENUM(nap::EOscCaptureMode)
+	RTTI_ENUM_VALUE(nap::EOscCaptureMode::Off,			"Off"),
+	RTTI_ENUM_VALUE(nap::EOscCaptureMode::Record,		"Record"),
+	RTTI_ENUM_VALUE(nap::EOscCaptureMode::Replay,		"Replay")
+RTTI_END_ENUM
+
+RTTI_BEGIN_CLASS(nap::OscCaptureComponent)
+	RTTI_PROPERTY("Mode",				&nap::OscCaptureComponent::mMode,				nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("Path",				&nap::OscCaptureComponent::mPath,				nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("Speed",				&nap::OscCaptureComponent::mSpeed,				nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("FloodCount",			&nap::OscCaptureComponent::mFloodCount,			nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("Loop",				&nap::OscCaptureComponent::mLoop,				nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("BaselineFrames",		&nap::OscCaptureComponent::mBaselineFrames,		nap::rtti::EPropertyMetaData::Default)
+RTTI_END_CLASS
+
+RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::OscCaptureComponentInstance)
+	RTTI_CONSTRUCTOR(nap::EntityInstance&, nap::Component&)
+RTTI_END_CLASS
+
+namespace nap
+{
+	// Capture file header
+	static constexpr char sMagic[4] = { 'N', 'O', 'S', 'C' };
+	static constexpr uint32 sVersion = 1;
+
+
+	// Appends the bytes of a value
+	template<typename T>
+	static void append(std::vector<char>& buffer, const T& value)
+	{
+		const char* bytes = reinterpret_cast<const char*>(&value);
+		buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+	}
+
+
+	/**
+	 * Serializes a message into the buffer
+	 * @return false if the message holds an unsupported argument type
+	 */
+	static bool serialize(const OSCEvent& event, std::vector<char>& buffer)
+	{
+		buffer.clear();
+		const auto& address = event.getAddress();
+		buffer.insert(buffer.end(), address.c_str(), address.c_str() + address.size() + 1);
+		append(buffer, static_cast<uint32>(event.getCount()));
+		for (int i = 0; i < static_cast<int>(event.getCount()); i++)
+		{
+			const auto& argument = event[i];
+			if (const auto* v = argument.get<OSCFloat>())
+			{
+				buffer.emplace_back('f');
+				append(buffer, v->mValue);
+			}
+			else if (const auto* v = argument.get<OSCInt>())
+			{
+				buffer.emplace_back('i');
+				append(buffer, v->mValue);
+			}
+			else if (const auto* v = argument.get<OSCDouble>())
+			{
+				buffer.emplace_back('d');
+				append(buffer, v->mValue);
+			}
+			else if (const auto* v = argument.get<OSCBool>())
+			{
+				buffer.emplace_back(v->mValue ? 'T' : 'F');
+			}
+			else if (const auto* v = argument.get<OSCString>())
+			{
+				buffer.emplace_back('s');
+				buffer.insert(buffer.end(), v->mString.c_str(), v->mString.c_str() + v->mString.size() + 1);
+			}
+			else if (const auto* v = argument.get<OSCBlob>())
+			{
+				buffer.emplace_back('b');
+				append(buffer, static_cast<uint32>(v->getSize()));
+				const char* data = static_cast<const char*>(v->getData());
+				buffer.insert(buffer.end(), data, data + v->getSize());
+			}
+			else
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	/**
+	 * Reads values from a capture, every read is bounds checked
+	 */
+	class CaptureReader
+	{
+	public:
+		CaptureReader(const char* data, size_t size) : mData(data), mEnd(data + size) { }
+
+		template<typename T>
+		bool read(T& value)
+		{
+			if (static_cast<size_t>(mEnd - mData) < sizeof(T))
+				return false;
+			std::memcpy(&value, mData, sizeof(T));
+			mData += sizeof(T);
+			return true;
+		}
+
+		bool readString(std::string& value)
+		{
+			const char* end = std::find(mData, mEnd, '\0');
+			if (end == mEnd)
+				return false;
+			value.assign(mData, end);
+			mData = end + 1;
+			return true;
+		}
+
+		bool readBytes(size_t size, const char*& bytes)
+		{
+			if (static_cast<size_t>(mEnd - mData) < size)
+				return false;
+			bytes = mData;
+			mData += size;
+			return true;
+		}
+
+		bool atEnd() const										{ return mData == mEnd; }
+
+	private:
+		const char* mData;
+		const char* mEnd;
+	};
+
+
+	/**
+	 * Decodes a serialized message
+	 * @return the message, nullptr if the data is invalid
+	 */
+	static OSCEventPtr deserialize(const char* data, size_t size)
+	{
+		CaptureReader reader(data, size);
+		std::string address;
+		uint32 count = 0;
+		if (!reader.readString(address) || !reader.read(count))
+			return nullptr;
+
+		auto event = std::make_unique<OSCEvent>(address);
+		for (uint32 i = 0; i < count; i++)
+		{
+			char tag = 0;
+			if (!reader.read(tag))
+				return nullptr;
+
+			switch (tag)
+			{
+				case 'f':
+				{
+					float value = 0.0f;
+					if (!reader.read(value))
+						return nullptr;
+					event->addValue<float>(value);
+					break;
+				}
+				case 'i':
+				{
+					int value = 0;
+					if (!reader.read(value))
+						return nullptr;
+					event->addValue<int>(value);
+					break;
+				}
+				case 'd':
+				{
+					double value = 0.0;
+					if (!reader.read(value))
+						return nullptr;
+					event->addValue<double>(value);
+					break;
+				}
+				case 'T':
+				case 'F':
+				{
+					event->addValue<bool>(tag == 'T');
+					break;
+				}
+				case 's':
+				{
+					std::string value;
+					if (!reader.readString(value))
+						return nullptr;
+					event->addString(value);
+					break;
+				}
+				case 'b':
+				{
+					uint32 blob_size = 0;
+					const char* bytes = nullptr;
+					if (!reader.read(blob_size) || !reader.readBytes(blob_size, bytes))
+						return nullptr;
+					event->addBlob(bytes, static_cast<int>(blob_size));
+					break;
+				}
+				default:
+					return nullptr;
+			}
+		}
+		if (!reader.atEnd())
+			return nullptr;
+		return event;
+	}
+
+
+	void OscCaptureComponent::getDependentComponents(std::vector<rtti::TypeInfo>& components) const
+	{
+		components.emplace_back(RTTI_OF(nap::OSCInputComponent));
+		components.emplace_back(RTTI_OF(nap::OscHandlerComponent));
+	}
+
+
+	OscCaptureComponentInstance::~OscCaptureComponentInstance()
+	{
+		stopReplay();
+		stopRecording();
+	}
+
+
+	bool OscCaptureComponentInstance::init(utility::ErrorState& errorState)
+	{
+		mResource = getComponent<OscCaptureComponent>();
+		if (!errorState.check(mResource->mSpeed >= 0.0f, "%s: 'Speed' can't be negative", mID.c_str()))
+			return false;
+
+		if (!errorState.check(mResource->mFloodCount > 0, "%s: 'FloodCount' must be higher than 0", mID.c_str()))
+			return false;
+
+		if (!errorState.check(mResource->mBaselineFrames >= 0, "%s: 'BaselineFrames' can't be negative", mID.c_str()))
+			return false;
+
+		OSCInputComponentInstance* osc_input = getEntityInstance()->findComponent<OSCInputComponentInstance>();
+		if (!errorState.check(osc_input != nullptr, "%s: missing OSCInputComponent", mID.c_str()))
+			return false;
+		osc_input->messageReceived.connect(eventReceivedSlot);
+
+		mHandler = getEntityInstance()->findComponent<OscHandlerComponentInstance>();
+		if (!errorState.check(mHandler != nullptr, "%s: missing OscHandlerComponent", mID.c_str()))
+			return false;
+
+		switch (mResource->mMode)
+		{
+			case EOscCaptureMode::Record:
+				return startRecording(mResource->mPath, errorState);
+			case EOscCaptureMode::Replay:
+				return startReplay(mResource->mPath, mResource->mSpeed, errorState);
+			default:
+				return true;
+		}
+	}
+
+
+	bool OscCaptureComponentInstance::startRecording(const std::string& path, utility::ErrorState& errorState)
+	{
+		stopReplay();
+		stopRecording();
+
+		mFile.open(path, std::ios::binary | std::ios::trunc);
+		if (!errorState.check(mFile.is_open(), "%s: unable to open capture '%s' for writing", mID.c_str(), path.c_str()))
+			return false;
+
+		uint32 version = sVersion;
+		mFile.write(sMagic, sizeof(sMagic));
+		mFile.write(reinterpret_cast<const char*>(&version), sizeof(version));
+		mRecordStart = std::chrono::steady_clock::now();
+		mRecordedCount = 0;
+		mSkippedCount = 0;
+		nap::Logger::info("%s: recording OSC to '%s'", mID.c_str(), path.c_str());
+		return true;
+	}
+
+
+	void OscCaptureComponentInstance::stopRecording()
+	{
+		if (!mFile.is_open())
+			return;
+
+		mFile.close();
+		nap::Logger::info("%s: recorded %llu OSC messages, skipped %llu with unsupported arguments", mID.c_str(),
+			static_cast<unsigned long long>(mRecordedCount), static_cast<unsigned long long>(mSkippedCount));
+	}
+
+
+	void OscCaptureComponentInstance::onEventReceived(const OSCEvent& event)
+	{
+		if (!mFile.is_open())
+			return;
+
+		if (!serialize(event, mBuffer))
+		{
+			mSkippedCount++;
+			return;
+		}
+
+		double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - mRecordStart).count();
+		uint32 size = static_cast<uint32>(mBuffer.size());
+		mFile.write(reinterpret_cast<const char*>(&time), sizeof(time));
+		mFile.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		mFile.write(mBuffer.data(), mBuffer.size());
+		if (!mFile.good())
+		{
+			nap::Logger::error("%s: unable to write capture, recording stopped", mID.c_str());
+			stopRecording();
+			return;
+		}
+		mRecordedCount++;
+	}
+
+
+	bool OscCaptureComponentInstance::startReplay(const std::string& path, float speed, utility::ErrorState& errorState)
+	{
+		stopReplay();
+		stopRecording();
+
+		std::ifstream file(path, std::ios::binary);
+		if (!errorState.check(file.is_open(), "%s: unable to open capture '%s'", mID.c_str(), path.c_str()))
+			return false;
+		std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+		CaptureReader reader(data.data(), data.size());
+		uint32 version = 0;
+		const char* bytes = nullptr;
+		if (!errorState.check(reader.readBytes(sizeof(sMagic), bytes) && std::memcmp(bytes, sMagic, sizeof(sMagic)) == 0 &&
+			reader.read(version) && version == sVersion, "%s: '%s' is not a valid OSC capture", mID.c_str(), path.c_str()))
+			return false;
+
+		// Decode all messages up front, replay only measures dispatch
+		std::vector<Record> records;
+		while (!reader.atEnd())
+		{
+			double time = 0.0;
+			uint32 size = 0;
+			if (!errorState.check(reader.read(time) && reader.read(size) && reader.readBytes(size, bytes), "%s: '%s' is truncated", mID.c_str(), path.c_str()))
+				return false;
+
+			auto event = deserialize(bytes, size);
+			if (!errorState.check(event != nullptr, "%s: '%s' holds an invalid message", mID.c_str(), path.c_str()))
+				return false;
+			records.push_back({ time, std::move(event) });
+		}
+
+		if (records.empty())
+		{
+			nap::Logger::warn("%s: '%s' holds no messages", mID.c_str(), path.c_str());
+			return true;
+		}
+
+		mRecords = std::move(records);
+		mSpeed = speed;
+		if (speed > 0.0f)
+			nap::Logger::info("%s: replaying %d OSC messages from '%s' at %.1fx", mID.c_str(), static_cast<int>(mRecords.size()), path.c_str(), speed);
+		else
+			nap::Logger::info("%s: replaying %d OSC messages from '%s' at %d per frame", mID.c_str(), static_cast<int>(mRecords.size()), path.c_str(), mResource->mFloodCount);
+
+		// Not enough idle frames to compare against, measure them before dispatching
+		mWaitForBaseline = mIdleFrames < static_cast<uint64>(mResource->mBaselineFrames);
+		if (mWaitForBaseline)
+		{
+			nap::Logger::info("%s: measuring baseline over %d frames before replaying", mID.c_str(), mResource->mBaselineFrames);
+			return true;
+		}
+		beginReplay();
+		return true;
+	}
+
+
+	void OscCaptureComponentInstance::beginReplay()
+	{
+		mWaitForBaseline = false;
+		mReport.mBaselineFrameTime = mIdleFrames > 0 ? mIdleFrameTime / static_cast<double>(mIdleFrames) : 0.0;
+		restartReplay();
+	}
+
+
+	void OscCaptureComponentInstance::stopReplay()
+	{
+		if (!isReplaying())
+			return;
+
+		// Finished passes are reported on completion
+		if (!mWaitForBaseline && mReport.mMessages > 0 && mNext < mRecords.size())
+		{
+			mReport.mDuration = std::chrono::duration<double>(std::chrono::steady_clock::now() - mPassStart).count();
+			logReport();
+		}
+
+		// The next baseline is measured from scratch
+		mRecords.clear();
+		mWaitForBaseline = false;
+		mIdleFrameTime = 0.0;
+		mIdleFrames = 0;
+	}
+
+
+	void OscCaptureComponentInstance::restartReplay()
+	{
+		double baseline = mReport.mBaselineFrameTime;
+		mReport = Report();
+		mReport.mBaselineFrameTime = baseline;
+
+		// Skip the silence before the first message
+		mNext = 0;
+		mReplayTime = mRecords.front().mTime;
+		mPassStart = std::chrono::steady_clock::now();
+	}
+
+
+	void OscCaptureComponentInstance::update(double deltaTime)
+	{
+		if (!isReplaying() || mWaitForBaseline)
+		{
+			mIdleFrameTime += deltaTime;
+			mIdleFrames++;
+			if (mWaitForBaseline && mIdleFrames >= static_cast<uint64>(mResource->mBaselineFrames))
+				beginReplay();
+			return;
+		}
+
+		mReport.mFrames++;
+		mReport.mFrameTime += deltaTime;
+		mReport.mMaxFrameTime = std::max(mReport.mMaxFrameTime, deltaTime);
+
+		// Find the last message that is due this frame
+		size_t end = mNext;
+		if (mSpeed > 0.0f)
+		{
+			mReplayTime += deltaTime * static_cast<double>(mSpeed);
+			while (end < mRecords.size() && mRecords[end].mTime <= mReplayTime)
+				end++;
+		}
+		else
+		{
+			end = std::min(mRecords.size(), mNext + static_cast<size_t>(mResource->mFloodCount));
+		}
+
+		auto dispatch_start = std::chrono::steady_clock::now();
+		for (; mNext < end; mNext++)
+			mHandler->onEventReceived(*mRecords[mNext].mEvent);
+		auto dispatch_end = std::chrono::steady_clock::now();
+		mReport.mDispatchTime += std::chrono::duration<double>(dispatch_end - dispatch_start).count();
+		mReport.mMessages = mNext;
+
+		if (mNext < mRecords.size())
+			return;
+
+		mReport.mDuration = std::chrono::duration<double>(dispatch_end - mPassStart).count();
+		logReport();
+		if (mResource->mLoop)
+			restartReplay();
+		else
+			stopReplay();
+	}
+
+
+	void OscCaptureComponentInstance::logReport() const
+	{
+		nap::Logger::info("%s: replayed %llu OSC messages in %.2f s, %.0f msg/s, handler dispatch %.0f msg/s", mID.c_str(),
+			static_cast<unsigned long long>(mReport.mMessages), mReport.mDuration, mReport.getMessagesPerSecond(), mReport.getDispatchRate());
+
+		double average_ms = mReport.getAverageFrameTime() * 1000.0;
+		double max_ms = mReport.mMaxFrameTime * 1000.0;
+		if (mReport.mBaselineFrameTime > 0.0)
+		{
+			double baseline_ms = mReport.mBaselineFrameTime * 1000.0;
+			nap::Logger::info("%s: frame time %.2f ms average, %.2f ms max, baseline %.2f ms, impact %+.2f ms", mID.c_str(),
+				average_ms, max_ms, baseline_ms, average_ms - baseline_ms);
+		}
+		else
+		{
+			nap::Logger::info("%s: frame time %.2f ms average, %.2f ms max, no baseline", mID.c_str(), average_ms, max_ms);
+		}
+	}
+}
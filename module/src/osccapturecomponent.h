@@ -0,0 +1,208 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+// External includes
+#include <component.h>
+#include <nap/signalslot.h>
+#include <oscevent.h>
+#include <chrono>
+#include <fstream>
+#include <vector>
+
+// Local includes
+#include "oschandlercomponent.h"
+
+namespace nap
+{
+	// Forward Declare
+	class OscCaptureComponentInstance;
+
+	/**
+	 * What the capture component does after init
+	 */
+	enum class EOscCaptureMode : int
+	{
+		Off		= 0,		///< Idle, recording and replay can be started at runtime
+		Record	= 1,		///< Records all messages of the OSC input component
+		Replay	= 2			///< Replays the capture into the OSC handler
+	};
+
+
+	/**
+	 * Records incoming OSC traffic to a timestamped binary log and replays it into the OSC handler, without network.
+	 *
+	 * Used to reproduce the load of a busy set and to measure dispatch throughput. The replay 'Speed' scales
+	 * the recorded timing, a speed of 0 ignores the timing and dispatches 'FloodCount' messages every frame,
+	 * the worst case a controller can produce. Every replay pass is reported as messages per second and
+	 * frame time compared to the frames before the replay started. A replay started without 'BaselineFrames'
+	 * idle frames behind it, such as the replay on init, waits until they are measured.
+	 *
+	 * The log starts with a header, followed by a record per message: the receive time in seconds, the size of
+	 * the message, the null terminated address, the argument count and every argument as type tag followed by
+	 * its value in native byte order. Float, int, double, bool, string and blob arguments are supported,
+	 * messages with other argument types are not recorded.
+	 */
+	class NAPAPI OscCaptureComponent : public Component
+	{
+		RTTI_ENABLE(Component)
+		DECLARE_COMPONENT(OscCaptureComponent, OscCaptureComponentInstance)
+	public:
+		/**
+		 * Get a list of all component types that this component is dependent on (i.e. must be initialized before this one)
+		 * @param components the components this object depends on
+		 */
+		void getDependentComponents(std::vector<rtti::TypeInfo>& components) const override;
+
+		EOscCaptureMode mMode = EOscCaptureMode::Off;					///< Property: 'Mode' record or replay on init
+		std::string mPath = "osc_capture.bin";							///< Property: 'Path' capture file
+		float mSpeed = 1.0f;											///< Property: 'Speed' replay speed, 0 for maximum speed
+		int mFloodCount = 10000;										///< Property: 'FloodCount' messages per frame at maximum speed
+		bool mLoop = false;												///< Property: 'Loop' restart the replay when it ends
+		int mBaselineFrames = 120;										///< Property: 'BaselineFrames' idle frames measured before a replay starts
+	};
+
+
+	/**
+	 * Records from the OSC input component and replays into the OSC handler of the same entity.
+	 * Replayed messages are decoded when the replay starts, dispatching measures the handler only.
+	 */
+	class NAPAPI OscCaptureComponentInstance : public ComponentInstance
+	{
+		RTTI_ENABLE(ComponentInstance)
+	public:
+		OscCaptureComponentInstance(EntityInstance& entity, Component& resource) : ComponentInstance(entity, resource) { }
+
+		// Closes the capture
+		virtual ~OscCaptureComponentInstance();
+
+		/**
+		 * Starts recording or replaying, based on the mode
+		 */
+		bool init(utility::ErrorState& errorState) override;
+
+		/**
+		 * Dispatches the recorded messages that are due
+		 * @param deltaTime time in between frames in seconds
+		 */
+		void update(double deltaTime) override;
+
+		/**
+		 * Starts recording to the given file, stops a running replay or recording
+		 * @param path the capture file, overwritten
+		 * @param errorState contains the error if the file can't be opened
+		 * @return if recording started
+		 */
+		bool startRecording(const std::string& path, utility::ErrorState& errorState);
+
+		/**
+		 * Stops recording and closes the file
+		 */
+		void stopRecording();
+
+		/**
+		 * Loads a capture and starts replaying it into the handler, stops a running replay or recording.
+		 * Dispatching is deferred until 'BaselineFrames' idle frames are measured.
+		 * @param path the capture file
+		 * @param speed replay speed, 0 for maximum speed
+		 * @param errorState contains the error if the capture can't be loaded
+		 * @return if the replay started
+		 */
+		bool startReplay(const std::string& path, float speed, utility::ErrorState& errorState);
+
+		/**
+		 * Stops the replay, reports the pass when messages were dispatched
+		 */
+		void stopReplay();
+
+		/**
+		 * @return if messages are being recorded
+		 */
+		bool isRecording() const										{ return mFile.is_open(); }
+
+		/**
+		 * @return if a capture is being replayed or waits for its baseline
+		 */
+		bool isReplaying() const										{ return !mRecords.empty(); }
+
+		/**
+		 * @return number of messages recorded since recording started
+		 */
+		uint64 getRecordedCount() const									{ return mRecordedCount; }
+
+		/**
+		 * Measurements of a single replay pass
+		 */
+		struct Report
+		{
+			uint64 mMessages = 0;										///< Messages dispatched
+			double mDuration = 0.0;										///< Wall time of the pass in seconds
+			double mDispatchTime = 0.0;									///< Time spent dispatching in seconds
+			uint64 mFrames = 0;											///< Frames during the pass
+			double mFrameTime = 0.0;									///< Summed frame time in seconds
+			double mMaxFrameTime = 0.0;									///< Longest frame in seconds
+			double mBaselineFrameTime = 0.0;							///< Average frame time before the replay, 0 if unknown
+
+			// Messages dispatched per second of replay
+			double getMessagesPerSecond() const							{ return mDuration > 0.0 ? static_cast<double>(mMessages) / mDuration : 0.0; }
+
+			// Messages the handler can dispatch per second
+			double getDispatchRate() const								{ return mDispatchTime > 0.0 ? static_cast<double>(mMessages) / mDispatchTime : 0.0; }
+
+			// Average frame time in seconds
+			double getAverageFrameTime() const							{ return mFrames > 0 ? mFrameTime / static_cast<double>(mFrames) : 0.0; }
+		};
+
+		/**
+		 * @return measurements of the running or last replay pass
+		 */
+		const Report& getReport() const									{ return mReport; }
+
+	private:
+		// Recorded message
+		struct Record
+		{
+			double mTime = 0.0;											///< Seconds since the start of the recording
+			OSCEventPtr mEvent;
+		};
+
+		// Writes a received message to the capture
+		void onEventReceived(const OSCEvent& event);
+
+		// Logs the report of the current pass
+		void logReport() const;
+
+		// Starts a new replay pass
+		void restartReplay();
+
+		// Takes the baseline from the idle frames and starts the first pass
+		void beginReplay();
+
+		Slot<const OSCEvent&> eventReceivedSlot = { this, &OscCaptureComponentInstance::onEventReceived };
+
+		OscCaptureComponent* mResource = nullptr;
+		OscHandlerComponentInstance* mHandler = nullptr;
+
+		// Recording
+		std::ofstream mFile;
+		std::vector<char> mBuffer;										///< Serialized message, reused
+		std::chrono::steady_clock::time_point mRecordStart;
+		uint64 mRecordedCount = 0;
+		uint64 mSkippedCount = 0;										///< Messages with unsupported arguments
+
+		// Replay
+		std::vector<Record> mRecords;
+		size_t mNext = 0;												///< Next record to dispatch
+		double mReplayTime = 0.0;										///< Position in the capture in seconds
+		float mSpeed = 1.0f;
+		bool mWaitForBaseline = false;									///< Loaded, measuring idle frames before dispatching
+		std::chrono::steady_clock::time_point mPassStart;
+		Report mReport;
+
+		// Frames outside of a replay, the baseline of the next replay
+		double mIdleFrameTime = 0.0;
+		uint64 mIdleFrames = 0;
+	};
+}
@@ -0,0 +1,244 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+// Local Includes
+#include "oscdispatchtable.h"
+
+// External Includes
+#include <algorithm>
+
+namespace nap
+{
+	/**
+	 * Splits the next segment of an address, advances the address past the segment.
+	 * @return if a segment was available
+	 */
+	static bool nextSegment(std::string_view& address, std::string_view& segment)
+	{
+		if (address.empty())
+			return false;
+
+		size_t end = address.find('/');
+		segment = address.substr(0, end);
+		address = end == std::string_view::npos ? std::string_view() : address.substr(end + 1);
+		return true;
+	}
+
+
+	// Strips the optional leading separator
+	static std::string_view stripRoot(std::string_view address)
+	{
+		return !address.empty() && address.front() == '/' ? address.substr(1) : address;
+	}
+
+
+	/**
+	 * Matches a single address segment against a single pattern segment.
+	 * @return if the name matches the pattern
+	 */
+	static bool matchSegment(std::string_view pattern, std::string_view name)
+	{
+		size_t n = 0;
+		for (size_t p = 0; p < pattern.size();)
+		{
+			switch (pattern[p])
+			{
+				case '*':
+				{
+					// Any sequence, try every remainder of the name
+					while (p < pattern.size() && pattern[p] == '*')
+						p++;
+					if (p == pattern.size())
+						return true;
+					for (size_t i = n; i <= name.size(); i++)
+					{
+						if (matchSegment(pattern.substr(p), name.substr(i)))
+							return true;
+					}
+					return false;
+				}
+				case '?':
+				{
+					if (n >= name.size())
+						return false;
+					p++; n++;
+					break;
+				}
+				case '[':
+				{
+					// Character list or range, optionally negated
+					size_t end = pattern.find(']', p + 1);
+					if (n >= name.size() || end == std::string_view::npos)
+						return false;
+
+					bool negate = p + 1 < end && pattern[p + 1] == '!';
+					bool found = false;
+					for (size_t i = p + (negate ? 2 : 1); i < end; i++)
+					{
+						if (i + 2 < end && pattern[i + 1] == '-')
+						{
+							found |= name[n] >= pattern[i] && name[n] <= pattern[i + 2];
+							i += 2;
+						}
+						else
+						{
+							found |= name[n] == pattern[i];
+						}
+					}
+					if (found == negate)
+						return false;
+					p = end + 1; n++;
+					break;
+				}
+				case '{':
+				{
+					// Alternatives, try every option followed by the rest of the pattern
+					size_t end = pattern.find('}', p + 1);
+					if (end == std::string_view::npos)
+						return false;
+
+					std::string_view options = pattern.substr(p + 1, end - p - 1);
+					std::string_view rest = pattern.substr(end + 1);
+					size_t start = 0;
+					while (true)
+					{
+						size_t comma = options.find(',', start);
+						std::string_view option = options.substr(start, comma == std::string_view::npos ? std::string_view::npos : comma - start);
+						if (name.substr(n, option.size()) == option && matchSegment(rest, name.substr(n + option.size())))
+							return true;
+						if (comma == std::string_view::npos)
+							return false;
+						start = comma + 1;
+					}
+				}
+				default:
+				{
+					if (n >= name.size() || name[n] != pattern[p])
+						return false;
+					p++; n++;
+					break;
+				}
+			}
+		}
+		return n == name.size();
+	}
+
+
+	int OscDispatchTable::getComponentCount(EType type)
+	{
+		switch (type)
+		{
+			case EType::Float:
+			case EType::Int:
+				return 1;
+			case EType::Vec2:
+				return 2;
+			case EType::Vec3:
+				return 3;
+			case EType::Vec4:
+			case EType::Color:
+				return 4;
+			default:
+				return 0;
+		}
+	}
+
+
+	bool OscDispatchTable::add(const std::string& address, EType type, Parameter* parameter)
+	{
+		int node_idx = 0;
+		std::string_view remainder = stripRoot(address);
+		std::string_view segment;
+		while (nextSegment(remainder, segment))
+		{
+			int child = findChild(mNodes[node_idx], segment);
+			if (child < 0)
+			{
+				// Insert new node, keep children sorted
+				child = static_cast<int>(mNodes.size());
+				mNodes.emplace_back().mSegment = std::string(segment);
+				auto& children = mNodes[node_idx].mChildren;
+				auto pos = std::lower_bound(children.begin(), children.end(), segment, [this](int idx, std::string_view value) {
+					return std::string_view(mNodes[idx].mSegment) < value;
+				});
+				children.insert(pos, child);
+			}
+			node_idx = child;
+		}
+
+		if (mNodes[node_idx].mEntry >= 0)
+			return false;
+
+		mNodes[node_idx].mEntry = static_cast<int>(mEntries.size());
+		mEntries.push_back({ address, type, parameter });
+		return true;
+	}
+
+
+	int OscDispatchTable::findChild(const Node& node, std::string_view segment) const
+	{
+		auto it = std::lower_bound(node.mChildren.begin(), node.mChildren.end(), segment, [this](int idx, std::string_view value) {
+			return std::string_view(mNodes[idx].mSegment) < value;
+		});
+		return it != node.mChildren.end() && mNodes[*it].mSegment == segment ? *it : -1;
+	}
+
+
+	const OscDispatchTable::Entry* OscDispatchTable::find(std::string_view address) const
+	{
+		int node_idx = 0;
+		std::string_view remainder = stripRoot(address);
+		std::string_view segment;
+		while (nextSegment(remainder, segment))
+		{
+			node_idx = findChild(mNodes[node_idx], segment);
+			if (node_idx < 0)
+				return nullptr;
+		}
+
+		int entry = mNodes[node_idx].mEntry;
+		return entry >= 0 ? &mEntries[entry] : nullptr;
+	}
+
+
+	void OscDispatchTable::match(std::string_view pattern, std::vector<int>& entries) const
+	{
+		match(0, stripRoot(pattern), entries);
+	}
+
+
+	void OscDispatchTable::match(int nodeIndex, std::string_view pattern, std::vector<int>& entries) const
+	{
+		const auto& node = mNodes[nodeIndex];
+		std::string_view segment;
+		if (!nextSegment(pattern, segment))
+		{
+			if (node.mEntry >= 0)
+				entries.emplace_back(node.mEntry);
+			return;
+		}
+
+		// Literal segments are looked up, only wildcards are tested against every child
+		if (!isPattern(segment))
+		{
+			int child = findChild(node, segment);
+			if (child >= 0)
+				match(child, pattern, entries);
+			return;
+		}
+
+		for (int child : node.mChildren)
+		{
+			if (matchSegment(segment, mNodes[child].mSegment))
+				match(child, pattern, entries);
+		}
+	}
+
+
+	void OscDispatchTable::clear()
+	{
+		mNodes = { Node() };
+		mEntries.clear();
+	}
+}
@@ -0,0 +1,170 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+// External includes
+#include <parameternumeric.h>
+#include <parametervec.h>
+#include <parametercolor.h>
+#include <utility/dllexport.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nap
+{
+	/**
+	 * Maps OSC addresses to parameters using a trie over the address segments.
+	 *
+	 * The table is built once, using add(), and is immutable afterwards. Every entry holds the parameter
+	 * together with its type, resolved when it is added: dispatching a message requires no type introspection.
+	 * Lookups take a string view and don't allocate, the cost depends on the number of segments in the address,
+	 * not on the number of registered parameters.
+	 *
+	 * A leading '/' is optional, 'laser/Amplitude' and '/laser/Amplitude' address the same entry.
+	 *
+	 * OSC 1.0 address patterns are resolved with match(), segment by segment: literal segments descend
+	 * the trie directly, only segments with wildcards are tested against the children of a node.
+	 */
+	class NAPAPI OscDispatchTable final
+	{
+	public:
+		/**
+		 * Resolved parameter type of an entry
+		 */
+		enum class EType : uint8
+		{
+			Float,
+			Int,
+			Vec2,
+			Vec3,
+			Vec4,
+			Color,					///< RGBA float color, alpha is optional
+			Batch					///< Sets many parameters from a single blob, has no parameter
+		};
+
+		/**
+		 * @return number of values of a parameter type, 0 for a batch
+		 */
+		static int getComponentCount(EType type);
+
+		/**
+		 * Registered address
+		 */
+		struct Entry
+		{
+			std::string mAddress;					///< Full address as registered
+			EType mType = EType::Float;				///< Type of the parameter
+			Parameter* mParameter = nullptr;		///< The parameter, of type mType, nullptr for a batch
+		};
+
+		/**
+		 * Registers a float parameter.
+		 * @param address OSC address of the parameter
+		 * @param parameter the parameter to control
+		 * @return false if the address is already registered
+		 */
+		bool add(const std::string& address, ParameterFloat& parameter)			{ return add(address, EType::Float, &parameter); }
+
+		/**
+		 * Registers an int parameter.
+		 * @param address OSC address of the parameter
+		 * @param parameter the parameter to control
+		 * @return false if the address is already registered
+		 */
+		bool add(const std::string& address, ParameterInt& parameter)			{ return add(address, EType::Int, &parameter); }
+
+		/**
+		 * Registers a vec2 parameter, set from 2 arguments.
+		 * @param address OSC address of the parameter
+		 * @param parameter the parameter to control
+		 * @return false if the address is already registered
+		 */
+		bool add(const std::string& address, ParameterVec2& parameter)			{ return add(address, EType::Vec2, &parameter); }
+
+		/**
+		 * Registers a vec3 parameter, set from 3 arguments.
+		 * @param address OSC address of the parameter
+		 * @param parameter the parameter to control
+		 * @return false if the address is already registered
+		 */
+		bool add(const std::string& address, ParameterVec3& parameter)			{ return add(address, EType::Vec3, &parameter); }
+
+		/**
+		 * Registers a vec4 parameter, set from 4 arguments.
+		 * @param address OSC address of the parameter
+		 * @param parameter the parameter to control
+		 * @return false if the address is already registered
+		 */
+		bool add(const std::string& address, ParameterVec4& parameter)			{ return add(address, EType::Vec4, &parameter); }
+
+		/**
+		 * Registers an RGBA color parameter, set from 3 or 4 arguments.
+		 * @param address OSC address of the parameter
+		 * @param parameter the parameter to control
+		 * @return false if the address is already registered
+		 */
+		bool add(const std::string& address, ParameterRGBAColorFloat& parameter)	{ return add(address, EType::Color, &parameter); }
+
+		/**
+		 * Registers a batch address, that sets many parameters from a single blob argument.
+		 * @param address OSC address of the batch
+		 * @return false if the address is already registered
+		 */
+		bool addBatch(const std::string& address)								{ return add(address, EType::Batch, nullptr); }
+
+		/**
+		 * Finds the entry registered at the given address, doesn't allocate.
+		 * @param address the address to find
+		 * @return the entry, nullptr if the address isn't registered
+		 */
+		const Entry* find(std::string_view address) const;
+
+		/**
+		 * Finds all entries that match an OSC 1.0 address pattern. Supports '?', '*', '[abc]', '[a-z]', '[!abc]'
+		 * and '{foo,bar}', wildcards don't match across '/'.
+		 * @param pattern the address pattern
+		 * @param entries receives the index of every matching entry, appended
+		 */
+		void match(std::string_view pattern, std::vector<int>& entries) const;
+
+		/**
+		 * @param address the address to test
+		 * @return if the address contains OSC pattern characters
+		 */
+		static bool isPattern(std::string_view address)							{ return address.find_first_of("*?[]{}") != std::string_view::npos; }
+
+		/**
+		 * @return all entries, in order of registration
+		 */
+		const std::vector<Entry>& getEntries() const							{ return mEntries; }
+
+		/**
+		 * Removes all entries
+		 */
+		void clear();
+
+	private:
+		// Single address segment
+		struct Node
+		{
+			std::string mSegment;
+			std::vector<int> mChildren;				///< Child nodes, sorted by segment
+			int mEntry = -1;						///< Entry that ends at this node, -1 if none
+		};
+
+		// Adds an entry of the given type
+		bool add(const std::string& address, EType type, Parameter* parameter);
+
+		// Returns the child of a node with the given segment, -1 if there is none
+		int findChild(const Node& node, std::string_view segment) const;
+
+		// Collects the entries below a node that match the remaining pattern
+		void match(int nodeIndex, std::string_view pattern, std::vector<int>& entries) const;
+
+		std::vector<Node> mNodes = { Node() };		///< Root is the first node
+		std::vector<Entry> mEntries;
+	};
+}
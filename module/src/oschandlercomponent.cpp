@@ -8,10 +8,15 @@
 #include <entity.h>
 #include <oscinputcomponent.h>
 #include <nap/logger.h>
+#include <utility/stringutils.h>
+#include <algorithm>
+#include <cstring>
 
 RTTI_BEGIN_CLASS(nap::OscHandlerComponent)
 	RTTI_PROPERTY("ParameterGroups",	&nap::OscHandlerComponent::mParameterGroups,	nap::rtti::EPropertyMetaData::Default)
 	RTTI_PROPERTY("Verbose",			&nap::OscHandlerComponent::mVerbose,			nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("BatchAddress",		&nap::OscHandlerComponent::mBatchAddress,		nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("BundleReceiver",		&nap::OscHandlerComponent::mBundleReceiver,		nap::rtti::EPropertyMetaData::Default)
 RTTI_END_CLASS
 
 RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::OscHandlerComponentInstance)
@@ -20,6 +25,63 @@ RTTI_END_CLASS
 
 namespace nap
 {
+	// Upper bound of cached patterns, guards against senders that generate unique patterns
+	static constexpr size_t sMaxCachedPatterns = 256;
+
+
+	/**
+	 * Reads a numeric argument as float
+	 * @return if the argument is numeric
+	 */
+	static bool toFloat(const OSCArgument& argument, float& value)
+	{
+		if (const auto* v = argument.get<OSCFloat>())
+			value = v->mValue;
+		else if (const auto* v = argument.get<OSCInt>())
+			value = static_cast<float>(v->mValue);
+		else if (const auto* v = argument.get<OSCDouble>())
+			value = static_cast<float>(v->mValue);
+		else
+			return false;
+		return true;
+	}
+
+
+	/**
+	 * Reads a numeric argument as int
+	 * @return if the argument is numeric
+	 */
+	static bool toInt(const OSCArgument& argument, int& value)
+	{
+		if (const auto* v = argument.get<OSCInt>())
+			value = v->mValue;
+		else if (const auto* v = argument.get<OSCFloat>())
+			value = static_cast<int>(v->mValue);
+		else if (const auto* v = argument.get<OSCDouble>())
+			value = static_cast<int>(v->mValue);
+		else
+			return false;
+		return true;
+	}
+
+
+	// Reads a big-endian 32 bit word from a blob
+	static uint32 readWord(const uint8* data)
+	{
+		return (static_cast<uint32>(data[0]) << 24) | (static_cast<uint32>(data[1]) << 16) | (static_cast<uint32>(data[2]) << 8) | static_cast<uint32>(data[3]);
+	}
+
+
+	// Reads a big-endian float from a blob
+	static float readFloat(const uint8* data)
+	{
+		uint32 word = readWord(data);
+		float value;
+		std::memcpy(&value, &word, sizeof(float));
+		return value;
+	}
+
+
     void OscHandlerComponent::getDependentComponents(std::vector<rtti::TypeInfo>& components) const
     {
         components.emplace_back(RTTI_OF(nap::OSCInputComponent));
@@ -47,70 +109,274 @@ namespace nap
 			{
 				for (const auto& filter : osc_input->mAddressFilter)
 				{
-					// Filter float parameters for simplicity
-					if (!param.get()->get_type().is_derived_from(RTTI_OF(ParameterFloat)) &&
-						!param.get()->get_type().is_derived_from(RTTI_OF(ParameterInt)))
+					// Construct an osc address for this parameter
+					std::vector<std::string> elements = { filter, param->getDisplayName() };
+					const auto address = utility::joinString(elements, "/");
+
+					// Resolve the parameter type once, dispatch doesn't inspect types
+					auto type = param.get()->get_type();
+					bool added = false;
+					if (type.is_derived_from(RTTI_OF(ParameterFloat)))
+						added = mDispatchTable.add(address, static_cast<ParameterFloat&>(*param));
+					else if (type.is_derived_from(RTTI_OF(ParameterInt)))
+						added = mDispatchTable.add(address, static_cast<ParameterInt&>(*param));
+					else if (type.is_derived_from(RTTI_OF(ParameterVec2)))
+						added = mDispatchTable.add(address, static_cast<ParameterVec2&>(*param));
+					else if (type.is_derived_from(RTTI_OF(ParameterVec3)))
+						added = mDispatchTable.add(address, static_cast<ParameterVec3&>(*param));
+					else if (type.is_derived_from(RTTI_OF(ParameterVec4)))
+						added = mDispatchTable.add(address, static_cast<ParameterVec4&>(*param));
+					else if (type.is_derived_from(RTTI_OF(ParameterRGBAColorFloat)))
+						added = mDispatchTable.add(address, static_cast<ParameterRGBAColorFloat&>(*param));
+					else
 					{
 						nap::Logger::warn("Skipping registration of '%s': unsupported parameter type", param->mID.c_str());
 						continue;
 					}
 
-					// Construct an osc address for this parameter
-					std::vector<std::string> elements = { filter, param->getDisplayName() };
-					const auto address = utility::joinString(elements, "/");
-					mCachedAddresses.emplace_back(address);
-
-					// Cast to float param
-					if (param.get()->get_type().is_derived_from(RTTI_OF(ParameterFloat)))
-						addParameter(address, static_cast<ParameterFloat&>(*param));
+					if (!added)
+					{
+						nap::Logger::warn("%s: Duplicate parameter with name: %s", mResource->mID.c_str(), param->getDisplayName().c_str());
+						continue;
+					}
 
-					// Cast to into param
-					else if (param.get()->get_type().is_derived_from(RTTI_OF(ParameterInt)))
-						addParameter(address, static_cast<ParameterInt&>(*param));
+					// Entry index equals the address index, used by batches
+					mCachedAddresses.emplace_back(address);
+					if (mResource->mVerbose)
+						nap::Logger::info("%s: Parameter %d registered with OSC address '%s'", mResource->mID.c_str(),
+							static_cast<int>(mCachedAddresses.size()) - 1, address.c_str());
 				}
 			}
 		}
+
+		// Batch addresses are registered after all parameters
+		if (!mResource->mBatchAddress.empty())
+		{
+			for (const auto& filter : osc_input->mAddressFilter)
+			{
+				std::vector<std::string> elements = { filter, mResource->mBatchAddress };
+				const auto address = utility::joinString(elements, "/");
+				if (!mDispatchTable.addBatch(address))
+					nap::Logger::warn("%s: Batch address '%s' conflicts with a parameter", mResource->mID.c_str(), address.c_str());
+			}
+		}
+
+		// Value slot for every registered address
+		mSlots = std::make_unique<ValueSlot[]>(mDispatchTable.getEntries().size());
         return true;
     }
 
 
-	void OscHandlerComponentInstance::updateParameter(const OSCEvent& oscEvent, Parameter& parameter)
+	void OscHandlerComponentInstance::storeValue(const OSCEvent& oscEvent, const OscDispatchTable::Entry& entry)
+	{
+		if (entry.mType == OscDispatchTable::EType::Batch)
+		{
+			storeBatch(oscEvent);
+			return;
+		}
+
+		// All components must be numeric, the alpha of a color is optional
+		auto& slot = mSlots[&entry - mDispatchTable.getEntries().data()];
+		int count = OscDispatchTable::getComponentCount(entry.mType);
+		int required = entry.mType == OscDispatchTable::EType::Color ? 3 : count;
+		if (oscEvent.getCount() < required)
+			return;
+
+		if (entry.mType == OscDispatchTable::EType::Int)
+		{
+			int value = 0;
+			if (!toInt(oscEvent[0], value))
+				return;
+			slot.mInt.store(value, std::memory_order_relaxed);
+		}
+		else
+		{
+			std::array<float, 4> values = { 0.0f, 0.0f, 0.0f, 1.0f };
+			int available = std::min(count, static_cast<int>(oscEvent.getCount()));
+			for (int i = 0; i < available; i++)
+			{
+				if (!toFloat(oscEvent[i], values[i]))
+					return;
+			}
+			for (int i = 0; i < count; i++)
+				slot.mValues[i].store(values[i], std::memory_order_relaxed);
+		}
+		publish(slot);
+	}
+
+
+	void OscHandlerComponentInstance::storeBatch(const OSCEvent& oscEvent)
+	{
+		const auto* blob = oscEvent.getCount() >= 1 ? oscEvent[0].get<OSCBlob>() : nullptr;
+		if (blob == nullptr)
+			return;
+
+		// Records of a parameter index followed by its values, stops at the first invalid record
+		const auto& entries = mDispatchTable.getEntries();
+		const auto* data = static_cast<const uint8*>(blob->getData());
+		const auto* end = data + blob->getSize();
+		while (end - data >= 4)
+		{
+			uint32 index = readWord(data);
+			if (index >= mCachedAddresses.size())
+				return;
+
+			const auto& entry = entries[index];
+			int count = OscDispatchTable::getComponentCount(entry.mType);
+			if (end - data < 4 + count * 4)
+				return;
+			data += 4;
+
+			auto& slot = mSlots[index];
+			if (entry.mType == OscDispatchTable::EType::Int)
+				slot.mInt.store(static_cast<int>(readWord(data)), std::memory_order_relaxed);
+			else
+			{
+				for (int i = 0; i < count; i++)
+					slot.mValues[i].store(readFloat(data + i * 4), std::memory_order_relaxed);
+			}
+			data += count * 4;
+			publish(slot);
+		}
+	}
+
+
+	void OscHandlerComponentInstance::publish(ValueSlot& slot)
+	{
+		// A value that wasn't applied yet is replaced
+		mReceivedCount.fetch_add(1, std::memory_order_relaxed);
+		if (slot.mPending.exchange(true, std::memory_order_release))
+			mDroppedCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+
+	void OscHandlerComponentInstance::updateParameter(const OscDispatchTable::Entry& entry, ValueSlot& slot)
     {
-    	assert(oscEvent.getCount() >= 1);
-    	if (parameter.get_type().is_derived_from(RTTI_OF(ParameterFloat)))
+    	const auto& v = slot.mValues;
+    	switch (entry.mType)
     	{
-    		const auto v = oscEvent[0].asFloat();
-    		static_cast<ParameterFloat&>(parameter).setValue(v);
-    		if (mResource->mVerbose)
-    			nap::Logger::info("%s: %s = %.02f", mResource->mID.c_str(), oscEvent.getAddress().c_str(), v);
+    		case OscDispatchTable::EType::Float:
+    		{
+    			const auto value = v[0].load(std::memory_order_relaxed);
+    			static_cast<ParameterFloat*>(entry.mParameter)->setValue(value);
+    			if (mResource->mVerbose)
+    				nap::Logger::info("%s: %s = %.02f", mResource->mID.c_str(), entry.mAddress.c_str(), value);
+    			break;
+    		}
+    		case OscDispatchTable::EType::Int:
+    		{
+    			const auto value = slot.mInt.load(std::memory_order_relaxed);
+    			static_cast<ParameterInt*>(entry.mParameter)->setValue(value);
+    			if (mResource->mVerbose)
+    				nap::Logger::info("%s: %s = %d", mResource->mID.c_str(), entry.mAddress.c_str(), value);
+    			break;
+    		}
+    		case OscDispatchTable::EType::Vec2:
+    		{
+    			static_cast<ParameterVec2*>(entry.mParameter)->setValue({ v[0].load(), v[1].load() });
+    			break;
+    		}
+    		case OscDispatchTable::EType::Vec3:
+    		{
+    			static_cast<ParameterVec3*>(entry.mParameter)->setValue({ v[0].load(), v[1].load(), v[2].load() });
+    			break;
+    		}
+    		case OscDispatchTable::EType::Vec4:
+    		{
+    			static_cast<ParameterVec4*>(entry.mParameter)->setValue({ v[0].load(), v[1].load(), v[2].load(), v[3].load() });
+    			break;
+    		}
+    		case OscDispatchTable::EType::Color:
+    		{
+    			static_cast<ParameterRGBAColorFloat*>(entry.mParameter)->setValue(RGBAColorFloat(v[0].load(), v[1].load(), v[2].load(), v[3].load()));
+    			break;
+    		}
+    		default:
+    			return;
     	}
-    	else if (parameter.get_type().is_derived_from(RTTI_OF(ParameterInt)))
+
+    	// Vectors and colors
+    	int count = OscDispatchTable::getComponentCount(entry.mType);
+    	if (mResource->mVerbose && count > 1)
     	{
-    		const auto v = oscEvent[0].asInt();
-    		static_cast<ParameterInt&>(parameter).setValue(v);
-    		if (mResource->mVerbose)
-    			nap::Logger::info("%s: %s = %d", mResource->mID.c_str(), oscEvent.getAddress().c_str(), v);
+    		std::vector<std::string> components;
+    		for (int i = 0; i < count; i++)
+    			components.emplace_back(utility::stringFormat("%.02f", v[i].load()));
+    		nap::Logger::info("%s: %s = (%s)", mResource->mID.c_str(), entry.mAddress.c_str(), utility::joinString(components, ", ").c_str());
     	}
     }
 
     
     void OscHandlerComponentInstance::onEventReceived(const OSCEvent& event)
     {
-		// Find matching osc function
-		auto osc_func = mOscEventFunctions.find(event.getAddress());
-		if (osc_func != mOscEventFunctions.end())
-			(this->*(osc_func->second.mFunction))(event, *(osc_func->second.mParameter));
+		// Find matching parameter, the value is applied on update
+		const auto* entry = mDispatchTable.find(event.getAddress());
+		if (entry != nullptr)
+		{
+			storeValue(event, *entry);
+			return;
+		}
+
+		// Set every parameter that matches the pattern, batches are only sent to their exact address
+		if (!OscDispatchTable::isPattern(event.getAddress()))
+			return;
+
+		const auto& entries = mDispatchTable.getEntries();
+		for (int index : matchPattern(event.getAddress()))
+		{
+			if (entries[index].mType != OscDispatchTable::EType::Batch)
+				storeValue(event, entries[index]);
+		}
     }
 
 
+	const std::vector<int>& OscHandlerComponentInstance::matchPattern(const std::string& pattern)
+	{
+		auto it = mPatternCache.find(pattern);
+		if (it != mPatternCache.end())
+			return it->second;
+
+		if (mPatternCache.size() >= sMaxCachedPatterns)
+			mPatternCache.clear();
+
+		auto& entries = mPatternCache[pattern];
+		mDispatchTable.match(pattern, entries);
+		if (mResource->mVerbose)
+			nap::Logger::info("%s: Pattern '%s' matches %d parameter(s)", mResource->mID.c_str(), pattern.c_str(), static_cast<int>(entries.size()));
+		return entries;
+	}
+
+
+	void OscHandlerComponentInstance::update(double deltaTime)
+	{
+		// Release scheduled bundle messages, stored like any other message
+		if (mResource->mBundleReceiver != nullptr)
+		{
+			mResource->mBundleReceiver->popDue(mResource->mBundleReceiver->getTime(), mDueEvents);
+			for (const auto& event : mDueEvents)
+				onEventReceived(*event);
+			mDueEvents.clear();
+		}
+
+		// Apply the latest value of every parameter that received messages since the last frame
+		const auto& entries = mDispatchTable.getEntries();
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			if (mSlots[i].mPending.exchange(false, std::memory_order_acquire))
+				updateParameter(entries[i], mSlots[i]);
+		}
+	}
+
+
 	bool OscHandlerComponentInstance::getParameterAddress(ParameterFloat* parameter, std::string& address) const
 	{
-		const auto& it = std::find_if(mOscEventFunctions.begin(), mOscEventFunctions.end(), [&](const auto& it) {
-			return it.second.mParameter == parameter;
+		const auto& entries = mDispatchTable.getEntries();
+		const auto& it = std::find_if(entries.begin(), entries.end(), [&](const auto& entry) {
+			return entry.mParameter == parameter;
 		});
-		if (it != mOscEventFunctions.end())
+		if (it != entries.end())
 		{
-			address = it->first;
+			address = it->mAddress;
 			return true;
 		}
 		return false;
@@ -9,9 +9,14 @@
 #include <nap/signalslot.h>
 #include <nap/logger.h>
 #include <oscevent.h>
-#include <queue>
 #include <parameternumeric.h>
 #include <parametergroup.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include "oscdispatchtable.h"
+#include "oscbundlereceiver.h"
 
 namespace nap
 {
@@ -20,6 +25,17 @@ namespace nap
    
 	/**
 	 * Component that converts incoming osc messages into a string and stores them for display later on.
+	 *
+	 * Every float, int, vec2, vec3, vec4 and RGBA color parameter is registered at 'filter/DisplayName'.
+	 * Vector and color parameters are set from a single message with one argument per component,
+	 * the alpha of a color is optional.
+	 *
+	 * Many parameters can be set at once by sending a single blob to 'filter/BatchAddress'. The blob holds
+	 * big-endian records of an int32 parameter index, the position in getAddresses(), followed by an int32
+	 * value for int parameters or a float32 value per component for all other types.
+	 *
+	 * Messages sent to an OSC address pattern, for example 'filter/{Red,Green}*', set every matching parameter.
+	 * A pattern is resolved once, the matching parameters are cached by pattern.
 	 */
     class NAPAPI OscHandlerComponent : public Component
     {
@@ -37,6 +53,8 @@ namespace nap
 
 		std::vector<ResourcePtr<ParameterGroup>>	mParameterGroups;
 		bool										mVerbose = false;
+		std::string									mBatchAddress = "batch";	///< Property: 'BatchAddress' address that sets many parameters from a single blob, empty to disable
+		ResourcePtr<OSCBundleReceiver>				mBundleReceiver;		///< Property: 'BundleReceiver' optional receiver of timetagged bundles, released when due
     };
 
     
@@ -58,59 +76,77 @@ namespace nap
 		// Return a list of all osc addresses
 		const std::vector<std::string>& getAddresses() const;
 
-    private:
 		/**
-		 * Called when the slot above is send a new message
+		 * Applies the latest received value of every parameter, once per frame.
+		 * Scheduled bundle messages that are due are applied together, in the same frame
+		 * @param deltaTime time in between frames in seconds
+		 */
+		void update(double deltaTime) override;
+
+		/**
+		 * @return number of messages received that matched a parameter
+		 */
+		uint64 getReceivedCount() const									{ return mReceivedCount.load(std::memory_order_relaxed); }
+
+		/**
+		 * @return number of messages that were overwritten by a newer message for the same parameter before being applied
+		 */
+		uint64 getDroppedCount() const									{ return mDroppedCount.load(std::memory_order_relaxed); }
+
+		/**
+		 * Routes a message to the matching parameters, the value is applied on update.
+		 * Called for every message of the OSC input component, messages can also be injected directly,
+		 * for example when replaying a capture.
 		 * @param OSCEvent the new osc event
 		 */
 		void onEventReceived(const OSCEvent&);
 
+    private:
 		/**
 		 * Slot that is connected to the osc input component that receives new messages
 		 */
         Slot<const OSCEvent&> eventReceivedSlot = { this, &OscHandlerComponentInstance::onEventReceived };
 
-		// This map holds all the various callbacks based on id
-		typedef void (OscHandlerComponentInstance::*OscEventFunc)(const OSCEvent&, Parameter&);
-
-		// Simple struct that binds a function to a parameter
-		struct OSCFunctionMapping
+		// Latest received value of a parameter, written on receive and applied on update
+		struct ValueSlot
 		{
-			OSCFunctionMapping(OscEventFunc oscFunction, Parameter& parameter) :
-				mFunction(oscFunction), mParameter(&parameter)	{ }
-
-			OscEventFunc mFunction = nullptr;
-			Parameter* mParameter  = nullptr;
+			std::array<std::atomic<float>, 4> mValues;		///< Float and vector components
+			std::atomic<int> mInt = { 0 };
+			std::atomic<bool> mPending = { false };
 		};
-		std::unordered_map<std::string, OSCFunctionMapping> mOscEventFunctions;
 
-		// Adds a parameter mapping
-    	template<typename T>
-		void addParameter(std::string oscAddress, ParameterNumeric<T>& parameter);
+		// Stores the arguments of a message in the slot of an entry, last write wins
+		void storeValue(const OSCEvent& oscEvent, const OscDispatchTable::Entry& entry);
+
+		// Stores all records of a batch blob
+		void storeBatch(const OSCEvent& oscEvent);
+
+		// Marks a slot as updated, counts the value it replaces as dropped
+		void publish(ValueSlot& slot);
+
+		// Applies the slot value to the parameter of an entry
+		void updateParameter(const OscDispatchTable::Entry& entry, ValueSlot& slot);
+
+		// Maps addresses to parameters, built on init
+		OscDispatchTable mDispatchTable;
+
+		// Returns the entries that match a pattern, resolved on first use
+		const std::vector<int>& matchPattern(const std::string& pattern);
 
-		// Generic parameter update function
-		void updateParameter(const OSCEvent& oscEvent, Parameter& parameter);
+		// Matching entry indices per received pattern, cleared when full
+		std::unordered_map<std::string, std::vector<int>> mPatternCache;
+
+		// Messages released by the bundle receiver this frame
+		std::vector<OSCEventPtr> mDueEvents;
+
+		// Value slot per dispatch table entry
+		std::unique_ptr<ValueSlot[]> mSlots;
+		std::atomic<uint64> mReceivedCount = { 0 };
+		std::atomic<uint64> mDroppedCount = { 0 };
 
 		// Cached list of addresses for display in the OSC menu
 		std::vector<std::string> mCachedAddresses;
 
 		OscHandlerComponent* mResource = nullptr;
 	};
-
-	// Template definitions
-	template<typename T>
-	void OscHandlerComponentInstance::addParameter(std::string oscAddress, ParameterNumeric<T>& parameter)
-	{
-		auto it = mOscEventFunctions.emplace(oscAddress, OSCFunctionMapping(&OscHandlerComponentInstance::updateParameter, parameter));
-		bool success = it.second;
-
-		if (!success)
-		{
-			nap::Logger::warn("%s: Duplicate parameter with name: %s", mResource->mID.c_str(), parameter.getDisplayName().c_str());
-		}
-		else if (mResource->mVerbose)
-		{
-			nap::Logger::info("%s: Parameter registered with OSC address '%s'", mResource->mID.c_str(), oscAddress.c_str());
-		}
-	}
 }
@@ -0,0 +1,175 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+// Local Includes
+#include "osctelemetrycomponent.h"
+
+// External Includes
+#include <entity.h>
+#include <nap/logger.h>
+#include <osc/OscOutboundPacketStream.h>
+#include <ip/UdpSocket.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+RTTI_BEGIN_CLASS(nap::OscTelemetryComponent)
+	RTTI_PROPERTY("Address",		&nap::OscTelemetryComponent::mAddress,			nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("Port",			&nap::OscTelemetryComponent::mPort,				nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("Rate",			&nap::OscTelemetryComponent::mRate,				nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("Prefix",			&nap::OscTelemetryComponent::mPrefix,			nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("LaserOutput",	&nap::OscTelemetryComponent::mLaserOutput,		nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("Playlist",		&nap::OscTelemetryComponent::mPlaylist,			nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("Parameters",		&nap::OscTelemetryComponent::mParameters,		nap::rtti::EPropertyMetaData::Default)
+RTTI_END_CLASS
+
+RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::OscTelemetryComponentInstance)
+	RTTI_CONSTRUCTOR(nap::EntityInstance&, nap::Component&)
+RTTI_END_CLASS
+
+namespace nap
+{
+	// Upper bound of the serialized size of a message without its address: size, type tags and up to 3 numeric arguments
+	static constexpr size_t sMessageSize = 32;
+
+
+	OscTelemetryComponentInstance::OscTelemetryComponentInstance(EntityInstance& entity, Component& resource) :
+		ComponentInstance(entity, resource)
+	{ }
+
+
+	OscTelemetryComponentInstance::~OscTelemetryComponentInstance()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mRunning = false;
+		}
+		mCondition.notify_one();
+		if (mThread.joinable())
+			mThread.join();
+	}
+
+
+	bool OscTelemetryComponentInstance::init(utility::ErrorState& errorState)
+	{
+		mResource = getComponent<OscTelemetryComponent>();
+		if (!errorState.check(mResource->mRate > 0.0f && mResource->mRate <= 1000.0f, "%s: 'Rate' must be in range 0-1000", mID.c_str()))
+			return false;
+
+		try
+		{
+			mSocket = std::make_unique<UdpTransmitSocket>(IpEndpointName(mResource->mAddress.c_str(), mResource->mPort));
+		}
+		catch (const std::runtime_error& exception)
+		{
+			errorState.fail("%s: unable to open socket to %s:%d: %s", mID.c_str(), mResource->mAddress.c_str(), mResource->mPort, exception.what());
+			return false;
+		}
+
+		// Addresses
+		mFrameAddress = mResource->mPrefix + "/frame";
+		mLaserAddress = mResource->mPrefix + "/laser";
+		mPlaylistAddress = mResource->mPrefix + "/playlist";
+		for (const auto& parameter : mResource->mParameters)
+			mParameterAddresses.emplace_back(mResource->mPrefix + "/param/" + parameter->getDisplayName());
+
+		// Bundle header, every message with its address and the playlist item string
+		size_t size = 16 + (sMessageSize + mFrameAddress.size()) + (sMessageSize + mLaserAddress.size()) +
+			(sMessageSize + mPlaylistAddress.size() + mSnapshot.mPlaylistItem.size());
+		for (const auto& address : mParameterAddresses)
+			size += sMessageSize + address.size();
+		mBuffer.resize(size);
+
+		mSnapshot.mParameters.resize(mResource->mParameters.size(), 0.0f);
+		mSendSnapshot.mParameters.resize(mResource->mParameters.size(), 0.0f);
+
+		mRunning = true;
+		mThread = std::thread([this] { run(); });
+		return true;
+	}
+
+
+	void OscTelemetryComponentInstance::update(double deltaTime)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSnapshot.mFrameTime += deltaTime;
+		mSnapshot.mMaxFrameTime = std::max(mSnapshot.mMaxFrameTime, deltaTime);
+		mSnapshot.mFrameCount++;
+
+		if (mLaserOutput != nullptr)
+		{
+			mSnapshot.mPointsPerSecond = mLaserOutput->getPointsPerSecond();
+			mSnapshot.mFrameFill = mLaserOutput->getFrameFill();
+		}
+
+		if (mPlaylist != nullptr)
+		{
+			mSnapshot.mPlaylistIndex = mPlaylist->getCurrentPlaylistIndex();
+			const auto& id = mPlaylist->getCurrentItem().mID;
+			size_t length = std::min(id.size(), mSnapshot.mPlaylistItem.size() - 1);
+			std::memcpy(mSnapshot.mPlaylistItem.data(), id.data(), length);
+			mSnapshot.mPlaylistItem[length] = '\0';
+		}
+
+		for (size_t i = 0; i < mResource->mParameters.size(); i++)
+			mSnapshot.mParameters[i] = mResource->mParameters[i]->mValue;
+	}
+
+
+	void OscTelemetryComponentInstance::run()
+	{
+		const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / static_cast<double>(mResource->mRate)));
+		auto next = std::chrono::steady_clock::now();
+
+		std::unique_lock<std::mutex> lock(mMutex);
+		while (mRunning)
+		{
+			next += period;
+			if (mCondition.wait_until(lock, next, [this] { return !mRunning; }))
+				break;
+
+			// Take the values collected since the last bundle, frame statistics start over
+			mSendSnapshot = mSnapshot;
+			mSnapshot.mFrameTime = 0.0;
+			mSnapshot.mMaxFrameTime = 0.0;
+			mSnapshot.mFrameCount = 0;
+
+			lock.unlock();
+			send(mSendSnapshot);
+			lock.lock();
+		}
+	}
+
+
+	void OscTelemetryComponentInstance::send(const Snapshot& snapshot)
+	{
+		float frame_ms = snapshot.mFrameCount > 0 ? static_cast<float>(snapshot.mFrameTime / static_cast<double>(snapshot.mFrameCount) * 1000.0) : 0.0f;
+		float fps = snapshot.mFrameTime > 0.0 ? static_cast<float>(static_cast<double>(snapshot.mFrameCount) / snapshot.mFrameTime) : 0.0f;
+
+		try
+		{
+			osc::OutboundPacketStream stream(mBuffer.data(), mBuffer.size());
+			stream << osc::BeginBundleImmediate;
+			stream << osc::BeginMessage(mFrameAddress.c_str()) << frame_ms << static_cast<float>(snapshot.mMaxFrameTime * 1000.0) << fps << osc::EndMessage;
+
+			if (mLaserOutput != nullptr)
+				stream << osc::BeginMessage(mLaserAddress.c_str()) << snapshot.mPointsPerSecond << snapshot.mFrameFill << osc::EndMessage;
+
+			if (mPlaylist != nullptr)
+				stream << osc::BeginMessage(mPlaylistAddress.c_str()) << static_cast<osc::int32>(snapshot.mPlaylistIndex) << snapshot.mPlaylistItem.data() << osc::EndMessage;
+
+			for (size_t i = 0; i < mParameterAddresses.size(); i++)
+				stream << osc::BeginMessage(mParameterAddresses[i].c_str()) << snapshot.mParameters[i] << osc::EndMessage;
+
+			stream << osc::EndBundle;
+			mSocket->Send(stream.Data(), stream.Size());
+			mSentCount.fetch_add(1, std::memory_order_relaxed);
+		}
+		catch (const std::exception& exception)
+		{
+			if (!mSendFailed.exchange(true))
+				nap::Logger::warn("%s: unable to send telemetry: %s", mID.c_str(), exception.what());
+		}
+	}
+}
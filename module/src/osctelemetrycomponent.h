@@ -0,0 +1,124 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+// External includes
+#include <component.h>
+#include <componentptr.h>
+#include <parameternumeric.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Local includes
+#include "laseroutputcomponent.h"
+#include "playlistcontrolcomponent.h"
+
+// Forward declares
+class UdpTransmitSocket;
+
+namespace nap
+{
+	// Forward Declare
+	class OscTelemetryComponentInstance;
+
+	/**
+	 * Publishes the state of a running node as OSC bundles, for monitoring from a show controller.
+	 *
+	 * Every 1 / 'Rate' seconds a single bundle is sent to 'Address':'Port' holding:
+	 * - 'Prefix'/frame: average frame time in ms, max frame time in ms and frames per second since the last bundle
+	 * - 'Prefix'/laser: points sent per second and the fill of the last laser frame, when a laser output is linked
+	 * - 'Prefix'/playlist: index and id of the current item, when a playlist is linked
+	 * - 'Prefix'/param/'Name': value of every selected parameter
+	 */
+	class NAPAPI OscTelemetryComponent : public Component
+	{
+		RTTI_ENABLE(Component)
+		DECLARE_COMPONENT(OscTelemetryComponent, OscTelemetryComponentInstance)
+	public:
+		std::string mAddress = "127.0.0.1";							///< Property: 'Address' receiver IP address
+		int mPort = 7010;											///< Property: 'Port' receiver port
+		float mRate = 10.0f;										///< Property: 'Rate' bundles per second
+		std::string mPrefix = "/lovelights";						///< Property: 'Prefix' address prefix of all messages
+		ComponentPtr<LaserOutputComponent> mLaserOutput;			///< Property: 'LaserOutput' optional laser output to report
+		ComponentPtr<PlaylistControlComponent> mPlaylist;			///< Property: 'Playlist' optional playlist to report
+		std::vector<ResourcePtr<ParameterFloat>> mParameters;		///< Property: 'Parameters' parameters to report
+	};
+
+
+	/**
+	 * Collects telemetry every frame and sends it from a background thread.
+	 * All buffers are allocated on init, publishing doesn't allocate and never blocks the frame.
+	 */
+	class NAPAPI OscTelemetryComponentInstance : public ComponentInstance
+	{
+		RTTI_ENABLE(ComponentInstance)
+	public:
+		OscTelemetryComponentInstance(EntityInstance& entity, Component& resource);
+
+		// Stops the send thread
+		virtual ~OscTelemetryComponentInstance();
+
+		/**
+		 * Opens the socket, allocates buffers and starts the send thread
+		 */
+		bool init(utility::ErrorState& errorState) override;
+
+		/**
+		 * Collects the telemetry of this frame
+		 * @param deltaTime time in between frames in seconds
+		 */
+		void update(double deltaTime) override;
+
+		/**
+		 * @return number of bundles sent
+		 */
+		uint64 getSentCount() const									{ return mSentCount.load(std::memory_order_relaxed); }
+
+		ComponentInstancePtr<LaserOutputComponent> mLaserOutput = { this, &OscTelemetryComponent::mLaserOutput };
+		ComponentInstancePtr<PlaylistControlComponent> mPlaylist = { this, &OscTelemetryComponent::mPlaylist };
+
+	private:
+		// Values sent in a single bundle
+		struct Snapshot
+		{
+			double mFrameTime = 0.0;								///< Summed frame time in seconds
+			double mMaxFrameTime = 0.0;								///< Longest frame in seconds
+			uint64 mFrameCount = 0;									///< Frames since the last bundle
+			float mPointsPerSecond = 0.0f;
+			float mFrameFill = 0.0f;
+			int mPlaylistIndex = -1;
+			std::array<char, 64> mPlaylistItem = { };				///< Id of the current item, truncated
+			std::vector<float> mParameters;							///< Value per parameter, sized on init
+		};
+
+		// Sends bundles at the configured rate
+		void run();
+
+		// Writes and sends a bundle of the given snapshot
+		void send(const Snapshot& snapshot);
+
+		OscTelemetryComponent* mResource = nullptr;
+		std::unique_ptr<UdpTransmitSocket> mSocket;
+		std::vector<char> mBuffer;									///< Serialized bundle
+		std::string mFrameAddress;
+		std::string mLaserAddress;
+		std::string mPlaylistAddress;
+		std::vector<std::string> mParameterAddresses;				///< Address per parameter
+		std::atomic<bool> mSendFailed = { false };					///< Reported once
+
+		std::mutex mMutex;
+		std::condition_variable mCondition;
+		Snapshot mSnapshot;											///< Written by update, guarded by mutex
+		Snapshot mSendSnapshot;										///< Copy used by the send thread
+		std::thread mThread;
+		bool mRunning = false;										///< Guarded by mutex
+		std::atomic<uint64> mSentCount = { 0 };
+	};
+}
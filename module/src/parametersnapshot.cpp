@@ -0,0 +1,254 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+// Local Includes
+#include "parametersnapshot.h"
+#include "lovelightsservice.h"
+
+// External Includes
+#include <parameternumeric.h>
+#include <parametersimple.h>
+#include <parametervec.h>
+#include <parametercolor.h>
+#include <cstring>
+#include <thread>
+
+RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::ParameterSnapshot)
+	RTTI_CONSTRUCTOR(nap::LoveLightsService&)
+	RTTI_PROPERTY("Group",				&nap::ParameterSnapshot::mGroup,			nap::rtti::EPropertyMetaData::Required)
+RTTI_END_CLASS
+
+namespace nap
+{
+	// Failed read attempts before a reader yields to the writer
+	static constexpr int sSpinCount = 64;
+
+
+	// Returns the number of words of a type
+	static int getWordCount(ParameterSnapshot::EType type)
+	{
+		switch (type)
+		{
+			case ParameterSnapshot::EType::Vec2:
+				return 2;
+			case ParameterSnapshot::EType::Vec3:
+				return 3;
+			case ParameterSnapshot::EType::Vec4:
+			case ParameterSnapshot::EType::Color:
+				return 4;
+			default:
+				return 1;
+		}
+	}
+
+
+	// Stores floats as words
+	static void toWords(const float* values, int count, uint32* words)
+	{
+		std::memcpy(words, values, count * sizeof(float));
+	}
+
+
+	// Adds a slot for every numeric parameter in a group and its children
+	static void addSlots(ParameterGroup& group, std::vector<ParameterSnapshot::Slot>& slots, std::unordered_map<std::string, int>& slotIndex, int& wordCount)
+	{
+		for (auto& member : group.mMembers)
+		{
+			auto type = member.get()->get_type();
+			ParameterSnapshot::EType slot_type;
+			if (type.is_derived_from(RTTI_OF(ParameterFloat)))
+				slot_type = ParameterSnapshot::EType::Float;
+			else if (type.is_derived_from(RTTI_OF(ParameterInt)))
+				slot_type = ParameterSnapshot::EType::Int;
+			else if (type.is_derived_from(RTTI_OF(ParameterBool)))
+				slot_type = ParameterSnapshot::EType::Bool;
+			else if (type.is_derived_from(RTTI_OF(ParameterVec2)))
+				slot_type = ParameterSnapshot::EType::Vec2;
+			else if (type.is_derived_from(RTTI_OF(ParameterVec3)))
+				slot_type = ParameterSnapshot::EType::Vec3;
+			else if (type.is_derived_from(RTTI_OF(ParameterVec4)))
+				slot_type = ParameterSnapshot::EType::Vec4;
+			else if (type.is_derived_from(RTTI_OF(ParameterRGBAColorFloat)))
+				slot_type = ParameterSnapshot::EType::Color;
+			else
+				continue;
+
+			slotIndex.emplace(member->mID, static_cast<int>(slots.size()));
+			slots.push_back({ member.get(), slot_type, wordCount });
+			wordCount += getWordCount(slot_type);
+		}
+
+		for (auto& child : group.mChildren)
+			addSlots(*child, slots, slotIndex, wordCount);
+	}
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// ParameterSnapshot::View
+	//////////////////////////////////////////////////////////////////////////
+
+	float ParameterSnapshot::View::getFloat(int slot) const
+	{
+		float value;
+		std::memcpy(&value, &mWords[(*mSlots)[slot].mOffset], sizeof(float));
+		return value;
+	}
+
+
+	int ParameterSnapshot::View::getInt(int slot) const
+	{
+		return static_cast<int>(mWords[(*mSlots)[slot].mOffset]);
+	}
+
+
+	glm::vec2 ParameterSnapshot::View::getVec2(int slot) const
+	{
+		glm::vec2 value;
+		std::memcpy(&value[0], &mWords[(*mSlots)[slot].mOffset], sizeof(value));
+		return value;
+	}
+
+
+	glm::vec3 ParameterSnapshot::View::getVec3(int slot) const
+	{
+		glm::vec3 value;
+		std::memcpy(&value[0], &mWords[(*mSlots)[slot].mOffset], sizeof(value));
+		return value;
+	}
+
+
+	glm::vec4 ParameterSnapshot::View::getVec4(int slot) const
+	{
+		glm::vec4 value;
+		std::memcpy(&value[0], &mWords[(*mSlots)[slot].mOffset], sizeof(value));
+		return value;
+	}
+
+
+	RGBAColorFloat ParameterSnapshot::View::getColor(int slot) const
+	{
+		glm::vec4 value = getVec4(slot);
+		return RGBAColorFloat(value.r, value.g, value.b, value.a);
+	}
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// ParameterSnapshot
+	//////////////////////////////////////////////////////////////////////////
+
+	ParameterSnapshot::ParameterSnapshot(LoveLightsService& service) :
+		mService(service)
+	{ }
+
+
+	bool ParameterSnapshot::init(utility::ErrorState& errorState)
+	{
+		int word_count = 0;
+		addSlots(*mGroup, mSlots, mSlotIndex, word_count);
+		if (!errorState.check(!mSlots.empty(), "%s: group %s holds no numeric parameters", mID.c_str(), mGroup->mID.c_str()))
+			return false;
+
+		mWordCount = word_count;
+		mWords.assign(word_count, 0);
+		mScratch.assign(word_count, 0);
+		mBlock = std::make_unique<std::atomic<uint32>[]>(word_count);
+		for (int i = 0; i < word_count; i++)
+			mBlock[i].store(0, std::memory_order_relaxed);
+
+		// Initial values are always published
+		mSequence.store(1, std::memory_order_relaxed);
+		publish();
+		mService.registerSnapshot(*this);
+		return true;
+	}
+
+
+	void ParameterSnapshot::onDestroy()
+	{
+		mService.unregisterSnapshot(*this);
+	}
+
+
+	void ParameterSnapshot::publish()
+	{
+		for (const auto& slot : mSlots)
+		{
+			uint32* words = &mScratch[slot.mOffset];
+			switch (slot.mType)
+			{
+				case EType::Float:
+					toWords(&static_cast<const ParameterFloat*>(slot.mParameter)->mValue, 1, words);
+					break;
+				case EType::Int:
+					words[0] = static_cast<uint32>(static_cast<const ParameterInt*>(slot.mParameter)->mValue);
+					break;
+				case EType::Bool:
+					words[0] = static_cast<const ParameterBool*>(slot.mParameter)->mValue ? 1 : 0;
+					break;
+				case EType::Vec2:
+					toWords(&static_cast<const ParameterVec2*>(slot.mParameter)->mValue[0], 2, words);
+					break;
+				case EType::Vec3:
+					toWords(&static_cast<const ParameterVec3*>(slot.mParameter)->mValue[0], 3, words);
+					break;
+				case EType::Vec4:
+					toWords(&static_cast<const ParameterVec4*>(slot.mParameter)->mValue[0], 4, words);
+					break;
+				case EType::Color:
+				{
+					glm::vec4 color = static_cast<const ParameterRGBAColorFloat*>(slot.mParameter)->mValue.toVec4();
+					toWords(&color[0], 4, words);
+					break;
+				}
+			}
+		}
+
+		// Readers keep their view when nothing changed, the initial publish is forced by an odd sequence
+		uint64 sequence = mSequence.load(std::memory_order_relaxed);
+		if (sequence % 2 == 0 && mScratch == mWords)
+			return;
+		mWords.swap(mScratch);
+
+		// Odd while writing, readers that overlap the write retry
+		uint64 begin = sequence % 2 == 0 ? sequence + 1 : sequence;
+		mSequence.store(begin, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		for (size_t i = 0; i < mWords.size(); i++)
+			mBlock[i].store(mWords[i], std::memory_order_relaxed);
+		mSequence.store(begin + 1, std::memory_order_release);
+	}
+
+
+	void ParameterSnapshot::read(View& view) const
+	{
+		view.mSlots = &mSlots;
+		view.mWords.resize(mWordCount);
+		for (int attempt = 1; ; attempt++)
+		{
+			uint64 begin = mSequence.load(std::memory_order_acquire);
+			if (begin % 2 == 0)
+			{
+				for (size_t i = 0; i < view.mWords.size(); i++)
+					view.mWords[i] = mBlock[i].load(std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (mSequence.load(std::memory_order_relaxed) == begin)
+				{
+					view.mVersion = begin / 2;
+					return;
+				}
+			}
+
+			// The writer holds the block for a single copy, give it time to finish
+			if (attempt % sSpinCount == 0)
+				std::this_thread::yield();
+		}
+	}
+
+
+	int ParameterSnapshot::findSlot(const std::string& parameterID) const
+	{
+		auto it = mSlotIndex.find(parameterID);
+		return it != mSlotIndex.end() ? it->second : -1;
+	}
+}
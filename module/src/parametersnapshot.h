@@ -0,0 +1,140 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+// External includes
+#include <nap/resource.h>
+#include <nap/resourceptr.h>
+#include <rtti/factory.h>
+#include <parametergroup.h>
+#include <color.h>
+#include <glm/glm.hpp>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace nap
+{
+	// Forward declares
+	class LoveLightsService;
+
+	/**
+	 * Publishes the values of a parameter group as a consistent snapshot, for readers on other threads.
+	 *
+	 * Parameters are written by OSC, the GUI and the blenders on the main thread. After every app update the
+	 * service copies the values of all numeric parameters of the group, including child groups, into a flat
+	 * block of words guarded by a sequence lock: the sequence is odd while the block is written. A reader
+	 * copies the block and retries when the sequence was odd or changed during the copy. Readers never take
+	 * a lock and never see a mix of two frames, the writer never waits for readers.
+	 *
+	 * The block is only republished when a value changed, View::getVersion() tells readers if anything changed.
+	 */
+	class NAPAPI ParameterSnapshot : public Resource
+	{
+		RTTI_ENABLE(Resource)
+	public:
+		ResourcePtr<ParameterGroup> mGroup;							///< Property: 'Group' parameters to publish, including child groups
+
+		/**
+		 * Type of a published parameter
+		 */
+		enum class EType : uint8
+		{
+			Float,
+			Int,
+			Bool,
+			Vec2,
+			Vec3,
+			Vec4,
+			Color
+		};
+
+		/**
+		 * Published parameter
+		 */
+		struct Slot
+		{
+			Parameter* mParameter = nullptr;
+			EType mType = EType::Float;
+			int mOffset = 0;										///< First word in the block
+		};
+
+		/**
+		 * Consistent copy of the published values, owned by a single reader
+		 */
+		class NAPAPI View
+		{
+			friend class ParameterSnapshot;
+		public:
+			float getFloat(int slot) const;
+			int getInt(int slot) const;
+			bool getBool(int slot) const							{ return getInt(slot) != 0; }
+			glm::vec2 getVec2(int slot) const;
+			glm::vec3 getVec3(int slot) const;
+			glm::vec4 getVec4(int slot) const;
+			RGBAColorFloat getColor(int slot) const;
+
+			/**
+			 * @return number of times the values changed, 0 before the first read
+			 */
+			uint64 getVersion() const								{ return mVersion; }
+
+		private:
+			const std::vector<Slot>* mSlots = nullptr;
+			std::vector<uint32> mWords;
+			uint64 mVersion = 0;
+		};
+
+		// Constructor
+		ParameterSnapshot(LoveLightsService& service);
+
+		/**
+		 * Creates the layout, publishes the current values and registers with the service
+		 */
+		bool init(utility::ErrorState& errorState) override;
+
+		/**
+		 * Unregisters from the service
+		 */
+		void onDestroy() override;
+
+		/**
+		 * Copies the current parameter values into the block when any of them changed.
+		 * Called by the service after every app update, main thread only.
+		 */
+		void publish();
+
+		/**
+		 * Copies the latest published values, lock free, from any thread.
+		 * Doesn't allocate after the first read into the same view.
+		 * @param view receives the values
+		 */
+		void read(View& view) const;
+
+		/**
+		 * @param parameterID id of the parameter
+		 * @return slot of the parameter, -1 if the parameter isn't published
+		 */
+		int findSlot(const std::string& parameterID) const;
+
+		/**
+		 * @return all published parameters
+		 */
+		const std::vector<Slot>& getSlots() const					{ return mSlots; }
+
+	private:
+		LoveLightsService& mService;
+		std::vector<Slot> mSlots;
+		std::unordered_map<std::string, int> mSlotIndex;
+		int mWordCount = 0;											///< Size of the block
+		std::vector<uint32> mWords;									///< Last published values, written by the main thread only
+		std::vector<uint32> mScratch;								///< Current values, compared against the published values
+		std::unique_ptr<std::atomic<uint32>[]> mBlock;				///< Block shared with readers
+		std::atomic<uint64> mSequence = { 0 };						///< Odd while the block is written
+	};
+
+	using ParameterSnapshotObjectCreator = rtti::ObjectCreator<ParameterSnapshot, LoveLightsService>;
+}
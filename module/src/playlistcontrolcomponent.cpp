@@ -5,6 +5,11 @@
 #include <nap/core.h>
 #include <mathutils.h>
 #include <nap/logger.h>
+#include <nap/resourcemanager.h>
+#include <utility/fileutils.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 
 // RTTI
 
@@ -26,9 +31,13 @@ RTTI_BEGIN_CLASS(nap::PlaylistControlComponent)
 	RTTI_PROPERTY("Items", &nap::PlaylistControlComponent::mItems, nap::rtti::EPropertyMetaData::Embedded)
 	RTTI_PROPERTY("IdleItem", &nap::PlaylistControlComponent::mIdleItem, nap::rtti::EPropertyMetaData::Embedded)
 	RTTI_PROPERTY("SelectItemIndex", &nap::PlaylistControlComponent::mSelectItemIndex, nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("SimulationClock", &nap::PlaylistControlComponent::mSimulationClock, nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("TempoClock", &nap::PlaylistControlComponent::mTempoClock, nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("OutputLatency", &nap::PlaylistControlComponent::mOutputLatency, nap::rtti::EPropertyMetaData::Default)
 	RTTI_PROPERTY("RandomizePlaylist", &nap::PlaylistControlComponent::mRandomizePlaylist, nap::rtti::EPropertyMetaData::Default)
 	RTTI_PROPERTY("Enable", &nap::PlaylistControlComponent::mEnable, nap::rtti::EPropertyMetaData::Default)
     RTTI_PROPERTY("Verbose", &nap::PlaylistControlComponent::mVerbose, nap::rtti::EPropertyMetaData::Default)
+    RTTI_PROPERTY("CachePresets", &nap::PlaylistControlComponent::mCachePresets, nap::rtti::EPropertyMetaData::Default)
 RTTI_END_CLASS
 
 RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::PlaylistControlComponentInstance)
@@ -37,6 +46,10 @@ RTTI_END_CLASS
 
 namespace nap
 {
+	// Interval in seconds at which cached presets are checked for changes
+	static constexpr double sWatchInterval = 1.0;
+
+
 	// utility function to find ParameterBlendComponentInstance* matched to ParameterBlendComponent*
 	static ParameterBlendComponentInstance* findBlender(const ParameterBlendComponent* component,
 		const std::vector<ParameterBlendComponentInstance*> blenders)
@@ -156,6 +169,13 @@ namespace nap
     // PlaylistControlComponentInstance
     //////////////////////////////////////////////////////////////////////////
 
+	PlaylistControlComponentInstance::~PlaylistControlComponentInstance()
+	{
+		if (mResource != nullptr && mResource->mSimulationClock != nullptr)
+			mResource->mSimulationClock->removeSimulation(mSimulation);
+	}
+
+
 	bool PlaylistControlComponentInstance::init(utility::ErrorState& errorState)
 	{
         // Fetch resource
@@ -193,6 +213,25 @@ namespace nap
 			mIdleItem = std::move(idle_item);
 		}
 
+		// Parse all presets up front, broken presets fail here instead of on the switch
+		if (mResource->mCachePresets)
+		{
+			auto start = std::chrono::steady_clock::now();
+			mPresetCache = std::make_unique<PresetCache>(getEntityInstance()->getCore()->getResourceManager()->getFactory());
+
+			for (auto& item : mPlaylist)
+			{
+				if (!cacheItem(item, errorState))
+					return false;
+			}
+			if (!cacheItem(mIdleItem, errorState))
+				return false;
+
+			// Always logged, start up time matters on the show machines
+			double load_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			Logger::info(*this, "Cached %d presets in %.1f ms", mPresetCache->getCount(), load_time);
+		}
+
 		// Exit early if there are no items
 		if (mPlaylist.empty())
 			return true;
@@ -232,6 +271,10 @@ namespace nap
 			}
         }
 
+		// Count simulation steps from now on
+		if (mResource->mSimulationClock != nullptr)
+			mResource->mSimulationClock->addSimulation(mSimulation);
+
 		if (mResource->mSelectItemIndex != nullptr)
 			mResource->mSelectItemIndex->valueChanged.connect(mSelectItemIndexChangedSlot);
 
@@ -239,14 +282,147 @@ namespace nap
 	}
 
 
+	bool PlaylistControlComponentInstance::cacheItem(Item& item, utility::ErrorState& errorState)
+	{
+		for (auto& group : item.mGroups)
+		{
+			group.mCached = mPresetCache->add(group.mPreset, *group.mParameterGroup, errorState);
+			if (!errorState.check(group.mCached != nullptr, "%s: unable to cache preset %s", mID.c_str(), group.mPreset.c_str()))
+				return false;
+		}
+		return true;
+	}
+
+
+	void PlaylistControlComponentInstance::reloadPresets()
+	{
+		utility::ErrorState error_state;
+		auto start = std::chrono::steady_clock::now();
+		int count = mPresetCache->reload(error_state);
+		double load_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (count < 0)
+		{
+			Logger::error(*this, "Unable to reload presets: %s", error_state.toString().c_str());
+			return;
+		}
+
+		if (count == 0)
+			return;
+
+		if (mVerbose)
+			Logger::info(*this, "Reloaded %d presets in %.1f ms", count, load_time);
+
+		// Show the changes of the current item right away
+		for (auto& group : mCurrentPlaylistItem->mGroups)
+		{
+			// Groups selected by hand keep their preset
+			auto* comp = group.mBlender->getComponent<ParameterBlendComponent>();
+			if (group.mCached == nullptr || !group.mCached->mChanged || comp->mPresetIndex->mValue != group.mPresetIndex)
+				continue;
+
+			// The index is unchanged, signal it so the blender loads the preset again
+			comp->mPresetBlendTime->setValue(0.0f);
+			comp->mPresetIndex->valueChanged(comp->mPresetIndex->mValue);
+		}
+	}
+
+
 	void PlaylistControlComponentInstance::update(double deltaTime)
 	{
+		// Reload changed presets, also when cycling is disabled and items are selected manually
+		if (mPresetCache != nullptr)
+		{
+			mWatchElapsedTime += deltaTime;
+			if (mWatchElapsedTime >= sWatchInterval)
+			{
+				mWatchElapsedTime = 0.0;
+				if (mCurrentPlaylistItem != nullptr)
+					reloadPresets();
+			}
+		}
+
+		// Steps the simulation clock ran since the last frame
+		uint64 steps = mSimulation.getSteps();
+		uint64 new_steps = steps - mLastSteps;
+		mLastSteps = steps;
+
 		if (!isEnabled() || mPlaylist.empty())
 			return;
 
+		// Measure the item in simulation steps when a clock is assigned: the item ends on a fixed step, independent
+		// of frame timing. Steps past the end are carried to the next item, frame latency doesn't accumulate.
+		double frame_time = deltaTime;
+		if (mResource->mSimulationClock != nullptr)
+		{
+			double period = mResource->mSimulationClock->getPeriod();
+			uint64 duration = std::max<uint64>(static_cast<uint64>(std::llround(mCurrentPlaylistItemDuration / period)), 1);
+			mItemElapsedSteps += new_steps;
+			mCurrentPlaylistItemElapsedTime = static_cast<float>(static_cast<double>(mItemElapsedSteps) * period);
+			if (mItemElapsedSteps < duration)
+				return;
+
+			if (mResource->mTempoClock != nullptr)
+			{
+				updateCue(frame_time);
+				return;
+			}
+
+			uint64 overshoot = mItemElapsedSteps - duration;
+			nextItem();
+			mItemElapsedSteps = overshoot;
+			return;
+		}
+
 		mCurrentPlaylistItemElapsedTime += deltaTime;
-		if (mCurrentPlaylistItemElapsedTime >= mCurrentPlaylistItemDuration)
-            nextItem();
+		if (mCurrentPlaylistItemElapsedTime < mCurrentPlaylistItemDuration)
+			return;
+
+		// Wait for the bar when locked to a tempo, cues are placed using the frame time
+		if (mResource->mTempoClock != nullptr)
+			updateCue(frame_time);
+		else
+			nextItem();
+	}
+
+
+	void PlaylistControlComponentInstance::updateCue(double frameTime)
+	{
+		// Cue on the first bar that can still be reached with the output latency.
+		// The clock renumbers its beats when the grid restarts or the downbeat moves, the bar is then picked again.
+		const auto& clock = *mResource->mTempoClock;
+		double latency = static_cast<double>(mResource->mOutputLatency);
+		double now = clock.getTime();
+		if (mCueBeat < 0 || mCueGridVersion != clock.getGridVersion())
+		{
+			mCueBeat = clock.getNextBar(now + latency);
+			mCueGridVersion = clock.getGridVersion();
+		}
+
+		// Fire in the frame closest to the beat minus the latency, the next frame is expected a frame time from now
+		double beat_time = clock.getBeatTime(mCueBeat);
+		if (now + frameTime * 0.5 < beat_time - latency)
+			return;
+
+		// Assumes the light leaves the laser one output latency from now, the error is the frame quantization
+		int64 beat = mCueBeat;
+		mCueError = now + latency - beat_time;
+		nextItem();
+
+		if (mVerbose)
+			Logger::info(*this, "Cued on beat %lld, dispatch error %+.1f ms, tempo %.1f bpm", static_cast<long long>(beat),
+				mCueError * 1000.0, clock.getTempo());
+	}
+
+
+	float PlaylistControlComponentInstance::getTransitionTime(const Item& item) const
+	{
+		if (mResource->mTempoClock == nullptr)
+			return item.mTransitionTime;
+
+		// At least a single beat
+		double period = mResource->mTempoClock->getPeriod();
+		double beats = std::max(std::round(static_cast<double>(item.mTransitionTime) / period), 1.0);
+		return static_cast<float>(beats * period);
 	}
 
 
@@ -295,14 +471,17 @@ namespace nap
         auto* item = getItem(mCurrentPlaylistIndex, randomize);
         mCurrentPlaylistItemDuration = item->mAverageDuration + math::random(-item->mDurationDeviation / 2.f, item->mDurationDeviation / 2.f);
         mCurrentPlaylistItemElapsedTime = 0.0f;
+        mItemElapsedSteps = 0;
         mCurrentPlaylistItem = item;
+        mCueBeat = -1;
 
         for (const auto& group : item->mGroups)
         {
+            float blend_time = immediate ? 0.0f : group.mImmediate ? 0.0f : getTransitionTime(getCurrentItem());
             auto* blender = group.mBlender;
             auto* comp = blender->getComponent<ParameterBlendComponent>();
             comp->mPresetIndex->setValue(group.mPresetIndex);
-            comp->mPresetBlendTime->setValue(immediate ? 0.0f : group.mImmediate ? 0.0f : getCurrentItem().mTransitionTime);
+            comp->mPresetBlendTime->setValue(blend_time);
         }
 
         if (mVerbose)
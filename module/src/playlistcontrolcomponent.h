@@ -6,6 +6,12 @@
 #include <parametergroup.h>
 #include <componentptr.h>
 #include <parameterblendcomponent.h>
+#include <atomic>
+#include <memory>
+
+#include "simulationclock.h"
+#include "presetcache.h"
+#include "tempoclock.h"
 
 #include "playlistcontrolcomponent.h"
 
@@ -17,6 +23,16 @@ namespace nap
      * Component that automatically selects presets on the ParameterBlendComponents
      * It cycles through a sequence of playlist items.
      * The order of the sequence can be shuffled and the duration of each preset can be randomized.
+     *
+     * Switching items selects the preset on the blender, which loads and blends it.
+     * When 'CachePresets' is enabled all presets of the playlist and the idle item are parsed on init,
+     * a broken preset fails init instead of the switch. Presets of the current item are loaded on the blender
+     * again when they change on disk.
+     *
+     * When a 'TempoClock' is assigned, an item that reached its duration switches on the next bar of the clock,
+     * in the frame closest to the beat, and transition times are rounded to whole beats. Cues fire 'OutputLatency'
+     * seconds early. The output latency is a manual calibration value, it is not measured: set it to the delay
+     * between a switch and the light leaving the laser, as observed on the rig.
      */
     class NAPAPI PlaylistControlComponent : public Component
     {
@@ -48,9 +64,13 @@ namespace nap
         std::vector<ResourcePtr<Item>> mItems;			// List of presets in the sequence accompanied by meta data
         ResourcePtr<Item> mIdleItem;                    //
         ResourcePtr<ParameterInt> mSelectItemIndex;     //
+        ResourcePtr<SimulationClock> mSimulationClock;  // Optional clock, item durations are measured in simulation steps instead of frame time
+        ResourcePtr<TempoClock> mTempoClock;            // Optional tempo, item changes are locked to bars and transitions to beats
+        float mOutputLatency = 0.0f;                    // Calibrated by hand, seconds between a cue and the light leaving the laser, cues fire this much early
 		bool mEnable;									// True to enable the preset cycle
         bool mRandomizePlaylist = false;				// Indicates whether the order of the cycle of presets will be shuffled
         bool mVerbose = true;							// Whether to log playlist changes
+        bool mCachePresets = false;						// Parse presets on init and reload them when they change on disk
     };
 
 
@@ -70,6 +90,7 @@ namespace nap
             std::string mPreset = "";
             bool mImmediate = false;
             int mPresetIndex = 0;
+            const PresetCache::Entry* mCached = nullptr;		// Cached preset, nullptr when not cached
         };
 
         struct Item
@@ -85,6 +106,9 @@ namespace nap
         };
 
         PlaylistControlComponentInstance(EntityInstance& entity, Component& resource) : ComponentInstance(entity, resource) { }
+
+        // Detaches from the simulation clock
+        ~PlaylistControlComponentInstance() override;
         
         // Initialize the component
         bool init(utility::ErrorState& errorState) override;
@@ -122,6 +146,13 @@ namespace nap
          */
         int getCurrentPlaylistIndex() const            { return mCurrentPlaylistIndex; }
 
+        /**
+         * Dispatch error of the last tempo locked cue: the frame that switched plus the output latency, minus the beat.
+         * Only covers frame quantization, the output latency is calibrated and not measured.
+         * @return dispatch error in seconds, positive when late
+         */
+        double getCueError() const                      { return mCueError; }
+
     private:
         // Checks validity of the preset index
         bool isIndexValid(int index) const             { return (index >= 0 && index < mPlaylist.size()) || index == IDLE_ITEM_INDEX; }
@@ -135,9 +166,32 @@ namespace nap
         // Selects the next preset in the sequence
         void nextItem();
 
+        // Switches to the next item on the frame closest to the next bar
+        void updateCue(double frameTime);
+
+        // Returns the transition time of an item, in whole beats when a tempo clock is assigned
+        float getTransitionTime(const Item& item) const;
+
+        // Parses the presets of an item and links the item to the cached entries
+        bool cacheItem(Item& item, utility::ErrorState& errorState);
+
+        // Reloads presets that changed on disk, applies them when part of the current item
+        void reloadPresets();
+
         void onSelectItem(int index) { setItem(index); }
         nap::Slot<int> mSelectItemIndexChangedSlot = { this, &PlaylistControlComponentInstance::onSelectItem };
 
+        // Counts the steps of the simulation clock on its thread, item durations are measured in steps
+        class StepCounter final : public Simulation
+        {
+        public:
+            void step(double time, double deltaTime) override  { mSteps.fetch_add(1); }
+            uint64 getSteps() const                             { return mSteps.load(); }
+        private:
+            std::atomic<uint64> mSteps = { 0 };
+        };
+        StepCounter mSimulation;
+
 		PlaylistControlComponent* mResource = nullptr;
 
         std::vector<Item> mPlaylist;
@@ -151,10 +205,19 @@ namespace nap
 
         float mCurrentPlaylistItemDuration = 0.0f;
         float mCurrentPlaylistItemElapsedTime = 0.0f;
-        Item* mCurrentPlaylistItem;
+        uint64 mItemElapsedSteps = 0;                   // Simulation steps since the current item started
+        uint64 mLastSteps = 0;                          // Simulation steps counted at the last frame
+        Item* mCurrentPlaylistItem = nullptr;
 
         bool mRandomizePlaylist = false;
         bool mVerbose = false;
+
+        std::unique_ptr<PresetCache> mPresetCache;
+        double mWatchElapsedTime = 0.0;
+
+        int64 mCueBeat = -1;                            // Beat the next item is cued on, -1 when not cued
+        uint64 mCueGridVersion = 0;                     // Grid version of the tempo clock the cue beat belongs to
+        double mCueError = 0.0;
     };
         
 }
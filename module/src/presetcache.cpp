@@ -0,0 +1,81 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+// Local Includes
+#include "presetcache.h"
+
+// External Includes
+#include <rtti/jsonreader.h>
+#include <utility/fileutils.h>
+
+namespace nap
+{
+	const PresetCache::Entry* PresetCache::add(const std::string& path, const ParameterGroup& group, utility::ErrorState& errorState)
+	{
+		auto it = mEntries.find(path);
+		if (it != mEntries.end())
+		{
+			if (!errorState.check(it->second->mGroup == &group, "Preset %s is used with more than one parameter group", path.c_str()))
+				return nullptr;
+			return it->second.get();
+		}
+
+		auto entry = std::make_unique<Entry>();
+		entry->mPath = path;
+		entry->mGroup = &group;
+		if (!parse(*entry, errorState))
+			return nullptr;
+
+		auto* result = entry.get();
+		mEntries.emplace(path, std::move(entry));
+		return result;
+	}
+
+
+	const PresetCache::Entry* PresetCache::find(const std::string& path) const
+	{
+		auto it = mEntries.find(path);
+		return it != mEntries.end() ? it->second.get() : nullptr;
+	}
+
+
+	int PresetCache::reload(utility::ErrorState& errorState)
+	{
+		int count = 0;
+		bool failed = false;
+		for (auto& pair : mEntries)
+		{
+			auto& entry = *pair.second;
+			entry.mChanged = false;
+			uint64 modification_time = 0;
+			if (!utility::getFileModificationTime(entry.mPath, modification_time) || modification_time == entry.mModificationTime)
+				continue;
+
+			// Retried on the next change only
+			entry.mModificationTime = modification_time;
+			if (!parse(entry, errorState))
+			{
+				failed = true;
+				continue;
+			}
+			entry.mChanged = true;
+			count++;
+		}
+		return failed ? -1 : count;
+	}
+
+
+	bool PresetCache::parse(Entry& entry, utility::ErrorState& errorState)
+	{
+		utility::getFileModificationTime(entry.mPath, entry.mModificationTime);
+
+		rtti::DeserializeResult result;
+		if (!rtti::readJSONFile(entry.mPath, rtti::EPropertyValidationMode::AllowMissingProperties, rtti::EPointerPropertyMode::NoRawPointers, mFactory, result, errorState))
+		{
+			errorState.fail("Unable to parse preset %s", entry.mPath.c_str());
+			return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,79 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+// External includes
+#include <parametergroup.h>
+#include <rtti/factory.h>
+#include <utility/dllexport.h>
+#include <utility/errorstate.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace nap
+{
+	/**
+	 * Preset files parsed once to validate them, and watched for changes.
+	 *
+	 * Presets are loaded and blended by the ParameterBlendComponent, the cache holds no parameter values.
+	 * add() deserializes a preset, a broken file is reported when the preset is added instead of when it is selected.
+	 * reload() parses the presets that changed on disk since they were added and marks them as changed.
+	 */
+	class NAPAPI PresetCache final
+	{
+	public:
+		/**
+		 * Cached preset file
+		 */
+		struct Entry
+		{
+			std::string mPath;
+			const ParameterGroup* mGroup = nullptr;		///< Group the preset applies to
+			uint64 mModificationTime = 0;
+			bool mChanged = false;						///< If the preset changed on disk in the last reload()
+		};
+
+		/**
+		 * @param factory used to deserialize presets
+		 */
+		PresetCache(rtti::Factory& factory) : mFactory(factory) { }
+
+		/**
+		 * Parses a preset of a group, does nothing if the preset is already cached.
+		 * @param path the preset file
+		 * @param group the group the preset applies to
+		 * @param errorState contains the error if the preset can't be parsed
+		 * @return the cached entry, nullptr on failure
+		 */
+		const Entry* add(const std::string& path, const ParameterGroup& group, utility::ErrorState& errorState);
+
+		/**
+		 * @param path the preset file
+		 * @return the cached entry, nullptr if the preset isn't cached
+		 */
+		const Entry* find(const std::string& path) const;
+
+		/**
+		 * Parses all presets that changed on disk since they were cached.
+		 * A preset that fails to parse isn't marked as changed.
+		 * @param errorState contains the errors of presets that failed to parse
+		 * @return number of presets reloaded, -1 if a preset failed to parse
+		 */
+		int reload(utility::ErrorState& errorState);
+
+		/**
+		 * @return number of cached presets
+		 */
+		int getCount() const									{ return static_cast<int>(mEntries.size()); }
+
+	private:
+		// Deserializes the preset file of an entry
+		bool parse(Entry& entry, utility::ErrorState& errorState);
+
+		rtti::Factory& mFactory;
+		std::unordered_map<std::string, std::unique_ptr<Entry>> mEntries;
+	};
+}
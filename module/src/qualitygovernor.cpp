@@ -0,0 +1,63 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+// Local Includes
+#include "qualitygovernor.h"
+
+namespace nap
+{
+	bool QualityGovernor::update(double time, double cost, double budget)
+	{
+		mAverage = mAverage < 0.0 ? cost : mAverage + (cost - mAverage) * static_cast<double>(mSmoothing);
+		if (budget <= 0.0)
+			return false;
+
+		// Track how long the cost has been over or under budget
+		double ratio = mAverage / budget;
+		if (ratio > static_cast<double>(mDegradeRatio))
+		{
+			mOverSince = mOverSince < 0.0 ? time : mOverSince;
+			mUnderSince = -1.0;
+		}
+		else if (ratio < static_cast<double>(mRecoverRatio))
+		{
+			mUnderSince = mUnderSince < 0.0 ? time : mUnderSince;
+			mOverSince = -1.0;
+		}
+		else
+		{
+			mOverSince = -1.0;
+			mUnderSince = -1.0;
+		}
+
+		// Let the measurements settle after a change
+		if (mChangeTime >= 0.0 && time - mChangeTime < static_cast<double>(mHoldTime))
+			return false;
+
+		int level = mLevel;
+		if (mOverSince >= 0.0 && time - mOverSince >= static_cast<double>(mDegradeDelay) && mLevel < mLevelCount)
+			level++;
+		else if (mUnderSince >= 0.0 && time - mUnderSince >= static_cast<double>(mRecoverDelay) && mLevel > 0)
+			level--;
+
+		if (level == mLevel)
+			return false;
+
+		mLevel = level;
+		mChangeTime = time;
+		mOverSince = -1.0;
+		mUnderSince = -1.0;
+		return true;
+	}
+
+
+	void QualityGovernor::reset()
+	{
+		mLevel = 0;
+		mAverage = -1.0;
+		mOverSince = -1.0;
+		mUnderSince = -1.0;
+		mChangeTime = -1.0;
+	}
+}
@@ -0,0 +1,74 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+// External includes
+#include <utility/dllexport.h>
+
+namespace nap
+{
+	/**
+	 * Picks a quality level from measured frame cost, 0 is full quality and every level above it one step degraded.
+	 *
+	 * The cost is smoothed and compared against the frame budget. Quality is lowered a single step when the
+	 * cost stays above 'DegradeRatio' of the budget for 'DegradeDelay' seconds and raised a single step when it
+	 * stays below 'RecoverRatio' for 'RecoverDelay' seconds. After every change the governor holds for 'HoldTime'
+	 * seconds to let the measurements settle, GPU timings lag a few frames behind.
+	 *
+	 * The governor only decides the level, applying it is up to the owner.
+	 */
+	class NAPAPI QualityGovernor final
+	{
+	public:
+		float mDegradeRatio = 0.9f;				///< Lower quality above this fraction of the budget
+		float mRecoverRatio = 0.6f;				///< Raise quality below this fraction of the budget
+		float mDegradeDelay = 0.5f;				///< Seconds the cost must be over budget before lowering quality
+		float mRecoverDelay = 3.0f;				///< Seconds the cost must be under budget before raising quality
+		float mHoldTime = 2.0f;					///< Seconds to wait after a change
+		float mSmoothing = 0.1f;				///< Weight of a new sample in the average cost
+
+		/**
+		 * @param levelCount number of degraded levels, the level is in range 0 - levelCount
+		 */
+		QualityGovernor(int levelCount) : mLevelCount(levelCount)	{ }
+
+		/**
+		 * Adds a frame cost sample and updates the level.
+		 * @param time current time in seconds
+		 * @param cost frame cost in milliseconds
+		 * @param budget frame budget in milliseconds
+		 * @return if the level changed
+		 */
+		bool update(double time, double cost, double budget);
+
+		/**
+		 * Returns to full quality and clears the average.
+		 */
+		void reset();
+
+		/**
+		 * @return current level, 0 is full quality
+		 */
+		int getLevel() const										{ return mLevel; }
+
+		/**
+		 * @return number of degraded levels
+		 */
+		int getLevelCount() const									{ return mLevelCount; }
+
+		/**
+		 * @return smoothed frame cost in milliseconds
+		 */
+		double getAverageCost() const								{ return mAverage; }
+
+	private:
+		int mLevelCount = 0;
+		int mLevel = 0;
+		double mAverage = -1.0;					///< Smoothed cost, negative until the first sample
+		double mOverSince = -1.0;				///< Time the cost went over budget, negative when under
+		double mUnderSince = -1.0;				///< Time the cost went under the recover ratio, negative when over
+		double mChangeTime = -1.0;				///< Time of the last change
+	};
+}
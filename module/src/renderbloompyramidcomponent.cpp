@@ -0,0 +1,315 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+// Local Includes
+#include "renderbloompyramidcomponent.h"
+
+// External Includes
+#include <entity.h>
+#include <nap/core.h>
+#include <renderservice.h>
+#include <uniforminstance.h>
+#include <samplerinstance.h>
+#include <utility/stringutils.h>
+
+RTTI_BEGIN_CLASS(nap::RenderBloomPyramidComponent)
+	RTTI_PROPERTY("InputTexture",			&nap::RenderBloomPyramidComponent::mInputTexture,			nap::rtti::EPropertyMetaData::Required)
+	RTTI_PROPERTY("OutputTexture",			&nap::RenderBloomPyramidComponent::mOutputTexture,			nap::rtti::EPropertyMetaData::Required)
+	RTTI_PROPERTY("DownsampleMaterial",		&nap::RenderBloomPyramidComponent::mDownsampleMaterial,		nap::rtti::EPropertyMetaData::Required)
+	RTTI_PROPERTY("UpsampleMaterial",		&nap::RenderBloomPyramidComponent::mUpsampleMaterial,		nap::rtti::EPropertyMetaData::Required)
+	RTTI_PROPERTY("LevelCount",				&nap::RenderBloomPyramidComponent::mLevelCount,				nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("Radius",					&nap::RenderBloomPyramidComponent::mRadius,					nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("Intensity",				&nap::RenderBloomPyramidComponent::mIntensity,				nap::rtti::EPropertyMetaData::Default)
+RTTI_END_CLASS
+
+RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::RenderBloomPyramidComponentInstance)
+	RTTI_CONSTRUCTOR(nap::EntityInstance&, nap::Component&)
+	RTTI_FUNCTION("draw", &nap::RenderBloomPyramidComponentInstance::draw)
+RTTI_END_CLASS
+
+namespace nap
+{
+	namespace bloom
+	{
+		static constexpr const char* UBO = "UBO";
+		static constexpr const char* texelSize = "texelSize";
+		static constexpr const char* radius = "radius";
+		static constexpr const char* highWeight = "highWeight";
+		static constexpr const char* intensity = "intensity";
+		static constexpr const char* colorTexture = "colorTexture";
+		static constexpr const char* lowTexture = "lowTexture";
+		static constexpr const char* highTexture = "highTexture";
+		static constexpr int maxLevelCount = 10;
+	}
+
+
+	/**
+	 * Sets the value of a uniform in the UBO struct, logs an error when not available.
+	 * @return if the uniform was set
+	 */
+	template<typename T, typename V>
+	static bool setUniform(MaterialInstance& material, const char* name, const V& value, utility::ErrorState& error)
+	{
+		UniformStructInstance* ubo = material.getOrCreateUniform(bloom::UBO);
+		if (!error.check(ubo != nullptr, "Unable to find uniform struct: %s", bloom::UBO))
+			return false;
+
+		T* uniform = ubo->getOrCreateUniform<T>(name);
+		if (!error.check(uniform != nullptr, "Unable to find uniform: %s in struct: %s", name, bloom::UBO))
+			return false;
+
+		uniform->setValue(value);
+		return true;
+	}
+
+
+	/**
+	 * Binds a texture to a sampler, logs an error when not available.
+	 * @return if the texture was bound
+	 */
+	static bool setTexture(MaterialInstance& material, const char* name, RenderTexture2D& texture, utility::ErrorState& error)
+	{
+		auto* sampler = material.getOrCreateSampler<Sampler2DInstance>(name);
+		if (!error.check(sampler != nullptr, "Unable to find sampler: %s", name))
+			return false;
+
+		sampler->setTexture(texture);
+		return true;
+	}
+
+
+	// Returns the texel size of a texture
+	static glm::vec2 getTexelSize(const RenderTexture2D& texture)
+	{
+		return { 1.0f / static_cast<float>(texture.getWidth()), 1.0f / static_cast<float>(texture.getHeight()) };
+	}
+
+
+	//////////////////////////////////////////////////////////////////////////
+	// RenderBloomPyramidComponentInstance
+	//////////////////////////////////////////////////////////////////////////
+
+	RenderBloomPyramidComponentInstance::RenderBloomPyramidComponentInstance(EntityInstance& entity, Component& resource) :
+		RenderableComponentInstance(entity, resource),
+		mRenderService(entity.getCore()->getService<RenderService>())
+	{ }
+
+
+	bool RenderBloomPyramidComponentInstance::init(utility::ErrorState& errorState)
+	{
+		if (!RenderableComponentInstance::init(errorState))
+			return false;
+
+		mResource = getComponent<RenderBloomPyramidComponent>();
+		auto& input = *mResource->mInputTexture;
+
+		// Every level must be at least a single texel
+		int level_count = mResource->mLevelCount;
+		if (!errorState.check(level_count >= 1 && level_count <= bloom::maxLevelCount, "%s: 'LevelCount' must be in range 1-%d", mID.c_str(), bloom::maxLevelCount))
+			return false;
+
+		if (!errorState.check((input.getWidth() >> level_count) >= 1 && (input.getHeight() >> level_count) >= 1,
+			"%s: input texture too small for %d levels", mID.c_str(), level_count))
+			return false;
+
+		// Full screen quad
+		mPlane = std::make_unique<PlaneMesh>(*getEntityInstance()->getCore());
+		mPlane->mSize = { 2.0f, 2.0f };
+		mPlane->mPosition = { 0.0f, 0.0f };
+		mPlane->mCullMode = ECullMode::None;
+		mPlane->mUsage = EMemoryUsage::Static;
+		if (!mPlane->init(errorState))
+			return false;
+
+		// Level targets, level n is 1/2^n of the input
+		for (int i = 1; i <= level_count; i++)
+		{
+			auto* target = createTarget(input.getWidth() >> i, input.getHeight() >> i, errorState);
+			if (target == nullptr)
+				return false;
+			mDownTargets.emplace_back(target);
+		}
+
+		for (int i = 1; i < level_count; i++)
+		{
+			auto* target = createTarget(input.getWidth() >> i, input.getHeight() >> i, errorState);
+			if (target == nullptr)
+				return false;
+			mUpTargets.emplace_back(target);
+		}
+
+		// Output target
+		auto* output_target = mTargets.emplace_back(std::make_unique<RenderTarget>(*getEntityInstance()->getCore())).get();
+		output_target->mColorTexture = mResource->mOutputTexture;
+		output_target->mSampleShading = false;
+		output_target->mRequestedSamples = ERasterizationSamples::One;
+		output_target->mClearColor = { 0.0f, 0.0f, 0.0f, 0.0f };
+		if (!output_target->init(errorState))
+			return false;
+
+		// Downsample, input -> level 1 -> level n
+		RenderTexture2D* source = &input;
+		for (auto* target : mDownTargets)
+		{
+			auto* pass = createPass(*target, *mResource->mDownsampleMaterial, errorState);
+			if (pass == nullptr ||
+				!setTexture(pass->mMaterialInstance, bloom::colorTexture, *source, errorState) ||
+				!setUniform<UniformVec2Instance>(pass->mMaterialInstance, bloom::texelSize, getTexelSize(*source), errorState))
+				return false;
+			mDownPasses.emplace_back(pass);
+			source = &target->getColorTexture();
+		}
+
+		// Upsample, level n -> level 1, every level adds the blurred level below
+		mUpPasses.resize(mUpTargets.size(), nullptr);
+		for (int i = static_cast<int>(mUpTargets.size()) - 1; i >= 0; i--)
+		{
+			auto* pass = createPass(*mUpTargets[i], *mResource->mUpsampleMaterial, errorState);
+			auto& high = mDownTargets[i]->getColorTexture();
+			if (pass == nullptr ||
+				!setTexture(pass->mMaterialInstance, bloom::lowTexture, *source, errorState) ||
+				!setTexture(pass->mMaterialInstance, bloom::highTexture, high, errorState) ||
+				!setUniform<UniformVec2Instance>(pass->mMaterialInstance, bloom::texelSize, getTexelSize(*source), errorState) ||
+				!setUniform<UniformFloatInstance>(pass->mMaterialInstance, bloom::radius, mResource->mRadius, errorState) ||
+				!setUniform<UniformFloatInstance>(pass->mMaterialInstance, bloom::highWeight, 1.0f, errorState) ||
+				!setUniform<UniformFloatInstance>(pass->mMaterialInstance, bloom::intensity, 1.0f, errorState))
+				return false;
+			mUpPasses[i] = pass;
+			source = &mUpTargets[i]->getColorTexture();
+		}
+
+		// Level 1 -> output, the levels are summed: normalize
+		auto* pass = createPass(*output_target, *mResource->mUpsampleMaterial, errorState);
+		if (pass == nullptr ||
+			!setTexture(pass->mMaterialInstance, bloom::lowTexture, *source, errorState) ||
+			!setTexture(pass->mMaterialInstance, bloom::highTexture, *source, errorState) ||
+			!setUniform<UniformVec2Instance>(pass->mMaterialInstance, bloom::texelSize, getTexelSize(*source), errorState) ||
+			!setUniform<UniformFloatInstance>(pass->mMaterialInstance, bloom::radius, mResource->mRadius, errorState) ||
+			!setUniform<UniformFloatInstance>(pass->mMaterialInstance, bloom::highWeight, 0.0f, errorState) ||
+			!setUniform<UniformFloatInstance>(pass->mMaterialInstance, bloom::intensity, mResource->mIntensity / static_cast<float>(level_count), errorState))
+			return false;
+		mOutputPass = pass;
+		mActiveLevelCount = level_count;
+
+		// Create all pipelines up front
+		for (auto& p : mPasses)
+		{
+			auto pipeline = mRenderService->getOrCreatePipeline(*p->mTarget, p->mRenderableMesh.getMesh(), p->mMaterialInstance, errorState);
+			if (!errorState.check(pipeline.mPipeline != VK_NULL_HANDLE, "%s: unable to create pipeline", mID.c_str()))
+				return false;
+		}
+
+		return true;
+	}
+
+
+	RenderTarget* RenderBloomPyramidComponentInstance::createTarget(int width, int height, utility::ErrorState& errorState)
+	{
+		const auto& input = *mResource->mInputTexture;
+		auto& texture = mTextures.emplace_back(std::make_unique<RenderTexture2D>(*getEntityInstance()->getCore()));
+		texture->mID = utility::stringFormat("%s_Texture%d", mID.c_str(), static_cast<int>(mTextures.size()));
+		texture->mWidth = width;
+		texture->mHeight = height;
+		texture->mColorFormat = input.mColorFormat;
+		texture->mColorSpace = input.mColorSpace;
+		texture->mUsage = Texture::EUsage::Static;
+		if (!texture->init(errorState))
+			return nullptr;
+
+		auto& target = mTargets.emplace_back(std::make_unique<RenderTarget>(*getEntityInstance()->getCore()));
+		target->mColorTexture = texture.get();
+		target->mSampleShading = false;
+		target->mRequestedSamples = ERasterizationSamples::One;
+		target->mClearColor = { 0.0f, 0.0f, 0.0f, 0.0f };
+		if (!target->init(errorState))
+			return nullptr;
+
+		return target.get();
+	}
+
+
+	RenderBloomPyramidComponentInstance::Pass* RenderBloomPyramidComponentInstance::createPass(RenderTarget& target, Material& material, utility::ErrorState& errorState)
+	{
+		auto& pass = mPasses.emplace_back(std::make_unique<Pass>());
+		pass->mTarget = &target;
+		pass->mMaterialResource.mMaterial = &material;
+		if (!pass->mMaterialInstance.init(*mRenderService, pass->mMaterialResource, errorState))
+			return nullptr;
+
+		pass->mRenderableMesh = mRenderService->createRenderableMesh(*mPlane, pass->mMaterialInstance, errorState);
+		if (!pass->mRenderableMesh.isValid())
+			return nullptr;
+
+		return pass.get();
+	}
+
+
+	void RenderBloomPyramidComponentInstance::setActiveLevelCount(int count)
+	{
+		count = glm::clamp(count, 1, getLevelCount());
+		if (count == mActiveLevelCount)
+			return;
+		mActiveLevelCount = count;
+
+		// The upsample chain starts at the last active level, every other level reads the upsampled level below it.
+		// Levels past the chain aren't drawn. Textures of the same level have the same size, the texel size uniforms remain valid.
+		utility::ErrorState error_state;
+		for (int i = 0; i < static_cast<int>(mUpPasses.size()); i++)
+		{
+			auto& low = i >= count - 2 ? mDownTargets[i + 1]->getColorTexture() : mUpTargets[i + 1]->getColorTexture();
+			setTexture(mUpPasses[i]->mMaterialInstance, bloom::lowTexture, low, error_state);
+		}
+
+		// The output reads the top of the chain
+		RenderTexture2D* source = count >= 2 ? &mUpTargets[0]->getColorTexture() : &mDownTargets[0]->getColorTexture();
+		setTexture(mOutputPass->mMaterialInstance, bloom::lowTexture, *source, error_state);
+		setTexture(mOutputPass->mMaterialInstance, bloom::highTexture, *source, error_state);
+		setUniform<UniformFloatInstance>(mOutputPass->mMaterialInstance, bloom::intensity, mResource->mIntensity / static_cast<float>(count), error_state);
+	}
+
+
+	void RenderBloomPyramidComponentInstance::draw()
+	{
+		// Downsample the active levels, upsample back from the last active level
+		for (int i = 0; i < mActiveLevelCount; i++)
+			drawPass(*mDownPasses[i]);
+
+		for (int i = mActiveLevelCount - 2; i >= 0; i--)
+			drawPass(*mUpPasses[i]);
+
+		drawPass(*mOutputPass);
+	}
+
+
+	void RenderBloomPyramidComponentInstance::drawPass(Pass& pass)
+	{
+		VkCommandBuffer command_buffer = mRenderService->getCurrentCommandBuffer();
+		pass.mTarget->beginRendering();
+
+		// Acquire new / unique descriptor set before rendering
+		const auto& descriptor_set = pass.mMaterialInstance.update();
+
+		// Fetch and bind pipeline
+		utility::ErrorState error_state;
+		auto pipeline = mRenderService->getOrCreatePipeline(*pass.mTarget, pass.mRenderableMesh.getMesh(), pass.mMaterialInstance, error_state);
+		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.mPipeline);
+		vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.mLayout, 0, 1, &descriptor_set.mSet, 0, nullptr);
+
+		// Bind vertex buffers
+		const auto& vertex_buffers = pass.mRenderableMesh.getVertexBuffers();
+		const auto& offsets = pass.mRenderableMesh.getVertexBufferOffsets();
+		vkCmdBindVertexBuffers(command_buffer, 0, vertex_buffers.size(), vertex_buffers.data(), offsets.data());
+
+		// Draw quad
+		const auto& gpu_mesh = mPlane->getMeshInstance().getGPUMesh();
+		for (int i = 0; i < mPlane->getMeshInstance().getNumShapes(); i++)
+		{
+			const auto& index_buffer = gpu_mesh.getIndexBuffer(i);
+			vkCmdBindIndexBuffer(command_buffer, index_buffer.getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+			vkCmdDrawIndexed(command_buffer, index_buffer.getCount(), 1, 0, 0, 0);
+		}
+
+		pass.mTarget->endRendering();
+	}
+}
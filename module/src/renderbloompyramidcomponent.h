@@ -0,0 +1,125 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+// External includes
+#include <rendercomponent.h>
+#include <rendertarget.h>
+#include <rendertexture2d.h>
+#include <materialinstance.h>
+#include <renderablemesh.h>
+#include <planemesh.h>
+#include <nap/resourceptr.h>
+
+namespace nap
+{
+	// Forward declares
+	class RenderBloomPyramidComponentInstance;
+
+	/**
+	 * Renders a bloom of the input texture into the output texture using a mip pyramid.
+	 *
+	 * The input is progressively downsampled into 'LevelCount' textures of half the size of the previous one,
+	 * using a small tent filter. The levels are then upsampled again with a 3x3 tent filter, every level
+	 * adding the blurred result of the level below it. The final upsample is written into the output texture.
+	 *
+	 * Compared to a separable gaussian blur at full resolution the glow is wider and a lot cheaper:
+	 * every level renders a quarter of the texels of the previous one.
+	 *
+	 * Can be used in place of a nap::RenderBloomComponent, input and output can be the same texture.
+	 * Call draw() in between RenderService::beginHeadlessRecording() and RenderService::endHeadlessRecording().
+	 */
+	class NAPAPI RenderBloomPyramidComponent : public RenderableComponent
+	{
+		RTTI_ENABLE(RenderableComponent)
+		DECLARE_COMPONENT(RenderBloomPyramidComponent, RenderBloomPyramidComponentInstance)
+	public:
+		ResourcePtr<RenderTexture2D> mInputTexture;							///< Property: 'InputTexture' the texture to bloom
+		ResourcePtr<RenderTexture2D> mOutputTexture;						///< Property: 'OutputTexture' the bloom result, can be the input texture
+		ResourcePtr<Material> mDownsampleMaterial;							///< Property: 'DownsampleMaterial' downsample material, see bloomdown.frag
+		ResourcePtr<Material> mUpsampleMaterial;							///< Property: 'UpsampleMaterial' upsample material, see bloomup.frag
+		int mLevelCount = 5;												///< Property: 'LevelCount' number of pyramid levels, every level doubles the glow radius
+		float mRadius = 1.0f;												///< Property: 'Radius' upsample filter radius in texels
+		float mIntensity = 1.0f;											///< Property: 'Intensity' output multiplier
+	};
+
+
+	/**
+	 * RenderBloomPyramidComponentInstance
+	 */
+	class NAPAPI RenderBloomPyramidComponentInstance : public RenderableComponentInstance
+	{
+		RTTI_ENABLE(RenderableComponentInstance)
+	public:
+		RenderBloomPyramidComponentInstance(EntityInstance& entity, Component& resource);
+
+		/**
+		 * Creates the pyramid textures, targets and pipelines
+		 */
+		bool init(utility::ErrorState& errorState) override;
+
+		/**
+		 * Renders the bloom into the output texture.
+		 * Call in between RenderService::beginHeadlessRecording() and RenderService::endHeadlessRecording().
+		 */
+		void draw();
+
+		/**
+		 * @return number of pyramid levels
+		 */
+		int getLevelCount() const												{ return static_cast<int>(mDownTargets.size()); }
+
+		/**
+		 * Limits the number of pyramid levels that are rendered, without recreating any resources.
+		 * Fewer levels render less passes and produce a narrower glow.
+		 * @param count number of levels to render, clamped to 1 - getLevelCount()
+		 */
+		void setActiveLevelCount(int count);
+
+		/**
+		 * @return number of pyramid levels that are rendered
+		 */
+		int getActiveLevelCount() const											{ return mActiveLevelCount; }
+
+	protected:
+		/**
+		 * The bloom is rendered offscreen in draw(), drawing into another target is not supported.
+		 */
+		void onDraw(IRenderTarget& renderTarget, VkCommandBuffer commandBuffer, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) override { }
+
+	private:
+		// Single full screen pass
+		struct Pass
+		{
+			RenderTarget* mTarget = nullptr;
+			MaterialInstanceResource mMaterialResource;
+			MaterialInstance mMaterialInstance;
+			RenderableMesh mRenderableMesh;
+		};
+
+		// Creates a texture and target of the given size
+		RenderTarget* createTarget(int width, int height, utility::ErrorState& errorState);
+
+		// Creates a pass that renders into the given target
+		Pass* createPass(RenderTarget& target, Material& material, utility::ErrorState& errorState);
+
+		// Records a single pass
+		void drawPass(Pass& pass);
+
+		RenderBloomPyramidComponent* mResource = nullptr;
+		RenderService* mRenderService = nullptr;
+
+		std::unique_ptr<PlaneMesh> mPlane;										///< Full screen quad
+		std::vector<std::unique_ptr<RenderTexture2D>> mTextures;				///< Owned level textures
+		std::vector<std::unique_ptr<RenderTarget>> mTargets;					///< Owned level targets
+		std::vector<RenderTarget*> mDownTargets;								///< Downsample targets, largest first
+		std::vector<RenderTarget*> mUpTargets;									///< Upsample targets, largest first, one less than down
+		std::vector<std::unique_ptr<Pass>> mPasses;								///< All passes in order of execution
+		std::vector<Pass*> mDownPasses;											///< Downsample passes, largest first
+		std::vector<Pass*> mUpPasses;											///< Upsample passes, largest first
+		Pass* mOutputPass = nullptr;											///< Level 1 -> output pass
+		int mActiveLevelCount = 0;												///< Number of rendered levels
+	};
+}
@@ -0,0 +1,130 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+// Local Includes
+#include "rendergraph.h"
+
+// External Includes
+#include <algorithm>
+#include <cassert>
+
+namespace nap
+{
+	RenderGraph::Stage& RenderGraph::addStage(const std::string& name, BeginFunction begin, PassFunction end, const std::string& consumer)
+	{
+		auto& stage = mStages.emplace_back();
+		stage.mName = name;
+		stage.mBegin = std::move(begin);
+		stage.mEnd = std::move(end);
+		stage.mConsumer = consumer;
+		mExecutionCount = 0;
+		return stage;
+	}
+
+
+	RenderGraph::Pass& RenderGraph::addPass(const std::string& name, PassFunction function, const std::string& consumer)
+	{
+		assert(!mStages.empty());
+		auto& stage = mStages.back();
+		auto& pass = stage.mPasses.emplace_back();
+		pass.mName = name;
+		pass.mFunction = std::move(function);
+		pass.mConsumer = consumer.empty() ? stage.mConsumer : consumer;
+		updateCulling();
+		return pass;
+	}
+
+
+	void RenderGraph::setConsumerActive(const std::string& consumer, bool active)
+	{
+		auto it = std::find(mInactiveConsumers.begin(), mInactiveConsumers.end(), consumer);
+		const bool is_active = it == mInactiveConsumers.end();
+		if (is_active == active)
+			return;
+
+		if (active)
+			mInactiveConsumers.erase(it);
+		else
+			mInactiveConsumers.emplace_back(consumer);
+		updateCulling();
+	}
+
+
+	void RenderGraph::updateCulling()
+	{
+		auto is_inactive = [this](const std::string& consumer)
+		{
+			return !consumer.empty() && std::find(mInactiveConsumers.begin(), mInactiveConsumers.end(), consumer) != mInactiveConsumers.end();
+		};
+
+		for (auto& stage : mStages)
+		{
+			bool all_culled = !stage.mPasses.empty();
+			for (auto& pass : stage.mPasses)
+			{
+				pass.mCulled = is_inactive(pass.mConsumer);
+				all_culled &= pass.mCulled;
+			}
+			stage.mCulled = is_inactive(stage.mConsumer) || all_culled;
+		}
+	}
+
+
+	void RenderGraph::execute()
+	{
+		for (auto& stage : mStages)
+		{
+			// Reset trace
+			stage.mRan = false;
+			for (auto& pass : stage.mPasses)
+				pass.mRan = false;
+
+			// Begin recording
+			if (!stage.mEnabled || stage.mCulled || (stage.mBegin && !stage.mBegin()))
+				continue;
+
+			// Record passes
+			for (auto& pass : stage.mPasses)
+			{
+				if (!pass.mEnabled || pass.mCulled)
+					continue;
+
+				pass.mFunction();
+				pass.mRan = true;
+				pass.mRunCount++;
+			}
+
+			// End recording
+			if (stage.mEnd)
+				stage.mEnd();
+			stage.mRan = true;
+		}
+		mExecutionCount++;
+	}
+
+
+	RenderGraph::Stage* RenderGraph::findStage(const std::string& name)
+	{
+		for (auto& stage : mStages)
+		{
+			if (stage.mName == name)
+				return &stage;
+		}
+		return nullptr;
+	}
+
+
+	RenderGraph::Pass* RenderGraph::findPass(const std::string& name)
+	{
+		for (auto& stage : mStages)
+		{
+			for (auto& pass : stage.mPasses)
+			{
+				if (pass.mName == name)
+					return &pass;
+			}
+		}
+		return nullptr;
+	}
+}
@@ -0,0 +1,136 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+// External includes
+#include <utility/dllexport.h>
+#include <nap/numeric.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace nap
+{
+	/**
+	 * Ordered list of render stages and passes that is resolved once and executed every frame.
+	 *
+	 * A stage wraps a recording scope, for example headless recording or recording into a window.
+	 * When the stage fails to begin, none of its passes run. A pass is a callback with everything it needs
+	 * (component lists, render masks, cameras and draw functions) resolved when the graph is built.
+	 * Executing the graph doesn't query the scene or perform reflection lookups and the graph itself doesn't allocate,
+	 * passes keep that guarantee by reusing containers that are sized when the graph is built.
+	 *
+	 * Every execution records which passes ran, see getStages().
+	 *
+	 * Stages and passes can name the output that consumes their result, for example the window that presents it.
+	 * When nobody needs that output, see setConsumerActive(), the stages and passes that only feed it are culled.
+	 * A stage is culled as a whole when all of its passes are culled.
+	 */
+	class NAPAPI RenderGraph final
+	{
+	public:
+		using BeginFunction = std::function<bool()>;
+		using PassFunction = std::function<void()>;
+
+		/**
+		 * Single pass, part of a stage
+		 */
+		struct Pass
+		{
+			std::string mName;						///< Display name
+			PassFunction mFunction;					///< Records the pass
+			std::string mConsumer;					///< Output that consumes the result of the pass, empty when always required
+			bool mEnabled = true;					///< If the pass is executed
+			bool mCulled = false;					///< If the pass is culled because its consumer is inactive
+			bool mRan = false;						///< If the pass ran during the last execution
+			uint64 mRunCount = 0;					///< Total number of times the pass ran
+			int mTimerScope = -1;					///< GPU timer scope that measures the pass, -1 when not measured
+		};
+
+		/**
+		 * Recording scope, holds passes
+		 */
+		struct Stage
+		{
+			std::string mName;						///< Display name
+			BeginFunction mBegin;					///< Begins recording, returns false to skip the stage, optional
+			PassFunction mEnd;						///< Ends recording, only called when begin succeeded, optional
+			std::vector<Pass> mPasses;				///< Passes in order of execution
+			std::string mConsumer;					///< Output that consumes the result of all passes, empty when always required
+			bool mEnabled = true;					///< If the stage is executed
+			bool mCulled = false;					///< If the stage is culled because no pass is required
+			bool mRan = false;						///< If the stage ran during the last execution
+		};
+
+		/**
+		 * Removes all stages and passes
+		 */
+		void clear()											{ mStages.clear(); mInactiveConsumers.clear(); }
+
+		/**
+		 * Adds a stage, passes added after this call are part of this stage
+		 * @param name display name of the stage
+		 * @param begin called before the passes are recorded, return false to skip the stage
+		 * @param end called after the passes are recorded
+		 * @param consumer output that consumes the result of the stage, empty when always required
+		 * @return the new stage
+		 */
+		Stage& addStage(const std::string& name, BeginFunction begin = nullptr, PassFunction end = nullptr, const std::string& consumer = "");
+
+		/**
+		 * Adds a pass to the last added stage
+		 * @param name display name of the pass
+		 * @param function records the pass
+		 * @param consumer output that consumes the result of the pass, empty to inherit the consumer of the stage
+		 * @return the new pass
+		 */
+		Pass& addPass(const std::string& name, PassFunction function, const std::string& consumer = "");
+
+		/**
+		 * Marks an output as (not) required. Stages and passes that only feed inactive outputs are culled.
+		 * Culling is resolved here, not on execution.
+		 * @param consumer name of the output
+		 * @param active if the output is required
+		 */
+		void setConsumerActive(const std::string& consumer, bool active);
+
+		/**
+		 * Executes all enabled stages and passes in order and records which passes ran
+		 */
+		void execute();
+
+		/**
+		 * Finds a stage by name
+		 * @param name name of the stage
+		 * @return the stage, nullptr if not found
+		 */
+		Stage* findStage(const std::string& name);
+
+		/**
+		 * Finds a pass by name
+		 * @param name name of the pass
+		 * @return the pass, nullptr if not found
+		 */
+		Pass* findPass(const std::string& name);
+
+		/**
+		 * @return all stages and the trace of the last execution
+		 */
+		const std::vector<Stage>& getStages() const				{ return mStages; }
+
+		/**
+		 * @return number of times the graph was executed since it was built
+		 */
+		uint64 getExecutionCount() const						{ return mExecutionCount; }
+
+	private:
+		// Updates the culled state of all stages and passes
+		void updateCulling();
+
+		std::vector<Stage> mStages;
+		std::vector<std::string> mInactiveConsumers;
+		uint64 mExecutionCount = 0;
+	};
+}
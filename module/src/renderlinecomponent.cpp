@@ -12,10 +12,17 @@
 #include <renderglobals.h>
 #include <transformcomponent.h>
 
+RTTI_BEGIN_ENUM(nap::ELineRenderMode)
+	RTTI_ENUM_VALUE(nap::ELineRenderMode::Strip,		"Strip"),
+	RTTI_ENUM_VALUE(nap::ELineRenderMode::Analytic,		"Analytic")
+RTTI_END_ENUM
+
 RTTI_BEGIN_CLASS(nap::RenderLineComponent)
 	RTTI_PROPERTY("MaterialInstance",	&nap::RenderLineComponent::mMaterialInstance,	nap::rtti::EPropertyMetaData::Default)
 	RTTI_PROPERTY("LineWidth",			&nap::RenderLineComponent::mLineWidth,			nap::rtti::EPropertyMetaData::Default)
 	RTTI_PROPERTY("PointSize",			&nap::RenderLineComponent::mPointSize,			nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("Mode",				&nap::RenderLineComponent::mMode,				nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("Feather",			&nap::RenderLineComponent::mFeather,			nap::rtti::EPropertyMetaData::Default)
 	RTTI_PROPERTY("ComputeLine",		&nap::RenderLineComponent::mComputeLine,		nap::rtti::EPropertyMetaData::Required)
 RTTI_END_CLASS
 
@@ -31,6 +38,12 @@ namespace nap
 		static constexpr const char* UBO = "UBO";
 		static constexpr const char* color = "color";
 		static constexpr const char* alpha = "alpha";
+		static constexpr const char* viewport = "viewport";
+		static constexpr const char* width = "width";
+		static constexpr const char* feather = "feather";
+		static constexpr const char* count = "count";
+		static constexpr const char* positions = "Positions";
+		static constexpr const char* colors = "Colors";
 	}
 
 
@@ -109,18 +122,56 @@ namespace nap
 			return false;
 
 		// Create mesh / material combo that can be rendered to target
-		mRenderableMesh = mRenderService->createRenderableMesh(*mMesh, mMaterialInstance, errorState);
-		if (!mRenderableMesh.isValid())
+		if (mResource->mMode == ELineRenderMode::Strip)
+		{
+			mRenderableMesh = mRenderService->createRenderableMesh(*mMesh, mMaterialInstance, errorState);
+			return mRenderableMesh.isValid();
+		}
+
+		// Analytic: line buffers and draw settings
+		UniformStructInstance* ubo = mMaterialInstance.getOrCreateUniform(uniform::UBO);
+		if (!errorState.check(ubo != nullptr, "%s: Unable to find uniform struct: %s", mID.c_str(), uniform::UBO))
+			return false;
+
+		mViewportUniform = getUniform<UniformVec2Instance>(uniform::viewport, *ubo, errorState);
+		mWidthUniform = getUniform<UniformFloatInstance>(uniform::width, *ubo, errorState);
+		mFeatherUniform = getUniform<UniformFloatInstance>(uniform::feather, *ubo, errorState);
+		mCountUniform = getUniform<UniformIntInstance>(uniform::count, *ubo, errorState);
+		if (mViewportUniform == nullptr || mWidthUniform == nullptr || mFeatherUniform == nullptr || mCountUniform == nullptr)
+			return false;
+
+		mPositionBinding = mMaterialInstance.getOrCreateBuffer<BufferBindingVec4Instance>(uniform::positions);
+		mColorBinding = mMaterialInstance.getOrCreateBuffer<BufferBindingVec4Instance>(uniform::colors);
+		if (!errorState.check(mPositionBinding != nullptr && mColorBinding != nullptr, "%s: Unable to find line buffers '%s' and '%s' in shader: %s",
+			mID.c_str(), uniform::positions, uniform::colors, mMaterialInstance.getMaterial().getShader().getDisplayName().c_str()))
+			return false;
+
+		mQuadMesh = std::make_unique<PlaneMesh>(*getEntityInstance()->getCore());
+		mQuadMesh->mCullMode = ECullMode::None;
+		mQuadMesh->mUsage = EMemoryUsage::Static;
+		if (!mQuadMesh->init(errorState))
 			return false;
 
-		return true;
+		mQuadRenderableMesh = mRenderService->createRenderableMesh(*mQuadMesh, mMaterialInstance, errorState);
+		return mQuadRenderableMesh.isValid();
+	}
+
+
+	bool RenderLineComponentInstance::createPipeline(const IRenderTarget& renderTarget, utility::ErrorState& errorState)
+	{
+		auto& renderable_mesh = mResource->mMode == ELineRenderMode::Strip ? mRenderableMesh : mQuadRenderableMesh;
+		if (!errorState.check(renderable_mesh.isValid(), "%s: invalid renderable mesh", mID.c_str()))
+			return false;
+
+		auto pipeline = mRenderService->getOrCreatePipeline(renderTarget, renderable_mesh.getMesh(), mMaterialInstance, errorState);
+		return pipeline.mPipeline != VK_NULL_HANDLE;
 	}
 
 
 	void RenderLineComponentInstance::onDraw(IRenderTarget& renderTarget, VkCommandBuffer commandBuffer, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix)
 	{
 		// Get material to work with
-		if (!mRenderableMesh.isValid())
+		if (!mRenderableMesh.isValid() && !mQuadRenderableMesh.isValid())
 		{
 			assert(false);
 			return;
@@ -142,6 +193,12 @@ namespace nap
 		// if (mCameraWorldPosUniform != nullptr)
 		// 	mCameraWorldPosUniform->setValue(math::extractPosition(glm::inverse(viewMatrix)));
 
+		if (mResource->mMode == ELineRenderMode::Analytic)
+		{
+			drawAnalytic(renderTarget, commandBuffer);
+			return;
+		}
+
 		// Acquire new / unique descriptor set before rendering
 		auto& mat_instance = mMaterialInstance;
 		const auto& descriptor_set = mat_instance.update();
@@ -186,10 +243,41 @@ namespace nap
 		// Draw points or lines
 		vkCmdSetLineWidth(commandBuffer, mResource->mLineWidth);
 
-		const auto& index_buffer = mMesh->getMeshInstance().getGPUMesh().getIndexBuffer(0);
-		vkCmdBindIndexBuffer(commandBuffer, index_buffer.getBuffer(), 0, VK_INDEX_TYPE_UINT32);
-		vkCmdDrawIndexed(commandBuffer, index_buffer.getCount(), 1, 0, 0, 0);
+		// Only draw the active part of the line, see LineMesh::getActiveCount().
+		// The strip is drawn in vertex order, the index buffer of the mesh instance isn't resized with the line.
+		vkCmdDraw(commandBuffer, mMesh->getActiveCount(), 1, 0, 0);
 
 		vkCmdSetLineWidth(commandBuffer, 1.0f);
 	}
+
+
+	void RenderLineComponentInstance::drawAnalytic(IRenderTarget& renderTarget, VkCommandBuffer commandBuffer)
+	{
+		const uint count = mMesh->getActiveCount();
+		if (count < 2)
+			return;
+
+		// Draw settings
+		mViewportUniform->setValue(glm::vec2(renderTarget.getBufferSize()));
+		mWidthUniform->setValue(mResource->mLineWidth);
+		mFeatherUniform->setValue(mResource->mFeather);
+		mCountUniform->setValue(static_cast<int>(count));
+
+		// The read buffers change when the line is resized
+		mPositionBinding->setBuffer(mMesh->getPositionBuffer(LineMesh::EBufferRank::Read));
+		mColorBinding->setBuffer(mMesh->getColorBuffer(LineMesh::EBufferRank::Read));
+
+		// Acquire new / unique descriptor set before rendering
+		const auto& descriptor_set = mMaterialInstance.update();
+
+		// Fetch and bind pipeline
+		utility::ErrorState error_state;
+		auto pipeline = mRenderService->getOrCreatePipeline(renderTarget, mQuadRenderableMesh.getMesh(), mMaterialInstance, error_state);
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.mPipeline);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.mLayout, 0, 1, &descriptor_set.mSet, 0, nullptr);
+
+		// Two triangles per segment, positions are fetched from the storage buffer in the vertex shader.
+		// Segments share mitered joins and don't overlap, every pixel is blended once.
+		vkCmdDraw(commandBuffer, (count - 1) * 6, 1, 0, 0);
+	}
 }
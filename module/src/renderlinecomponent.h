@@ -13,6 +13,8 @@
 #include <componentptr.h>
 #include <parameternumeric.h>
 #include <parametercolor.h>
+#include <planemesh.h>
+#include <bufferbindinginstance.h>
 
 // Local includes
 #include "computelinecomponent.h"
@@ -24,6 +26,16 @@ namespace nap
 	class TransformComponentInstance;
 	class PolyLine;
 
+	/**
+	 * How the line is rasterized
+	 */
+	enum class ELineRenderMode : int
+	{
+		Strip		= 0,		///< Line strip using the rasterizer line width, requires a multi-sampled target to be smooth
+		Analytic	= 1			///< Screen space quads with analytic coverage, smooth on single-sampled targets, requires line_aa shaders
+	};
+
+
 	/**
 	 * RenderLineComponent
 	 */
@@ -38,6 +50,8 @@ namespace nap
 		MaterialInstanceResource mMaterialInstance;								///< Property: 'Material' The material instance resource
 		float mLineWidth = 1.0f;												///< Property: 'LineWidth' line stroke width
 		float mPointSize = 32.0f;												///< Property: 'PointSize' point size
+		ELineRenderMode mMode = ELineRenderMode::Strip;							///< Property: 'Mode' how the line is rasterized
+		float mFeather = 1.0f;													///< Property: 'Feather' anti-aliased edge width in pixels, analytic mode only
 
 		ComponentPtr<ComputeLineComponent> mComputeLine;
 	};
@@ -63,6 +77,15 @@ namespace nap
 		 */
 		void onDraw(IRenderTarget& renderTarget, VkCommandBuffer commandBuffer, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) override;
 
+		/**
+		 * Creates the pipeline used to draw the line into the given target ahead of drawing.
+		 * Pipelines are cached by the render service, drawing into a target of the same format reuses it.
+		 * @param renderTarget the target to create the pipeline for
+		 * @param errorState contains the error if the pipeline can't be created
+		 * @return if the pipeline was created
+		 */
+		bool createPipeline(const IRenderTarget& renderTarget, utility::ErrorState& errorState);
+
 		/**
 		 * Returns the program used to render the mesh.
 		 *
@@ -75,6 +98,9 @@ namespace nap
 		MaterialInstance* getOrCreateMaterial() { return &mMaterialInstance; }
 
 	private:
+		// Draws the line as screen space quads with analytic coverage
+		void drawAnalytic(IRenderTarget& renderTarget, VkCommandBuffer commandBuffer);
+
 		ComponentInstancePtr<ComputeLineComponent> mComputeLine = { this, &RenderLineComponent::mComputeLine };
 
 		RenderLineComponent*				mResource = nullptr;				///< Reference to resource
@@ -92,5 +118,17 @@ namespace nap
 		UniformVec3Instance*				mCameraWorldPosUniform = nullptr;	///< Pointer to the camera world position uniform
 
 		LineMesh* 							mMesh = nullptr;
+
+		// Analytic mode: the vertex shader reads the line buffers directly and expands every segment into a quad,
+		// neighbouring quads share the mitered vertex at their join so no pixel is blended twice.
+		// The plane only provides the triangle list topology of the pipeline, none of its vertices are drawn.
+		std::unique_ptr<PlaneMesh>			mQuadMesh;
+		RenderableMesh						mQuadRenderableMesh;
+		UniformVec2Instance*				mViewportUniform = nullptr;			///< Pointer to the viewport uniform
+		UniformFloatInstance*				mWidthUniform = nullptr;			///< Pointer to the line width uniform
+		UniformFloatInstance*				mFeatherUniform = nullptr;			///< Pointer to the feather uniform
+		UniformIntInstance*					mCountUniform = nullptr;			///< Pointer to the active vertex count uniform
+		BufferBindingVec4Instance*			mPositionBinding = nullptr;			///< Line positions
+		BufferBindingVec4Instance*			mColorBinding = nullptr;			///< Line colors
 	};
 }
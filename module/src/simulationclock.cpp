@@ -0,0 +1,140 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+// Local Includes
+#include "simulationclock.h"
+
+// External Includes
+#include <algorithm>
+
+#ifdef _WIN32
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+	#include <timeapi.h>
+	#pragma comment(lib, "winmm.lib")
+
+	// Available since Windows 10 1803, not defined by older SDKs
+	#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+		#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+	#endif
+#endif
+
+RTTI_BEGIN_CLASS(nap::SimulationClock)
+	RTTI_PROPERTY("Frequency", &nap::SimulationClock::mFrequency, nap::rtti::EPropertyMetaData::Default)
+RTTI_END_CLASS
+
+namespace nap
+{
+	bool SimulationClock::init(utility::ErrorState& errorState)
+	{
+		return errorState.check(mFrequency >= 1.0f && mFrequency <= 10000.0f, "%s: 'Frequency' must be in range 1-10000 Hz", mID.c_str());
+	}
+
+
+	bool SimulationClock::start(utility::ErrorState& errorState)
+	{
+		mStartTime = std::chrono::steady_clock::now();
+		mSkippedCount = 0;
+		mRunning = true;
+		mThread = std::thread([this] { run(); });
+		return true;
+	}
+
+
+	void SimulationClock::stop()
+	{
+		mRunning = false;
+		if (mThread.joinable())
+			mThread.join();
+	}
+
+
+	void SimulationClock::addSimulation(Simulation& simulation)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSimulations.emplace_back(&simulation);
+	}
+
+
+	void SimulationClock::removeSimulation(Simulation& simulation)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mSimulations.erase(std::remove(mSimulations.begin(), mSimulations.end(), &simulation), mSimulations.end());
+	}
+
+
+	double SimulationClock::getTime() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - mStartTime).count();
+	}
+
+
+	void SimulationClock::run()
+	{
+		const double period = getPeriod();
+		const auto step_duration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(period));
+		auto next = mStartTime + step_duration;
+		uint64 step = 0;
+
+#ifdef _WIN32
+		// The default timer granularity (~15 ms) is coarser than a step: use a high resolution waitable timer,
+		// raise the system timer resolution when it isn't available
+		HANDLE timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+		if (timer == nullptr)
+			timeBeginPeriod(1);
+#endif
+
+		while (mRunning)
+		{
+#ifdef _WIN32
+			auto remaining = next - std::chrono::steady_clock::now();
+			if (timer != nullptr && remaining.count() > 0)
+			{
+				LARGE_INTEGER due;
+				due.QuadPart = -static_cast<LONGLONG>(std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count() / 100);
+				if (SetWaitableTimer(timer, &due, 0, nullptr, nullptr, FALSE))
+					WaitForSingleObject(timer, INFINITE);
+			}
+			else
+			{
+				std::this_thread::sleep_until(next);
+			}
+#else
+			std::this_thread::sleep_until(next);
+#endif
+
+			// Steps are never stretched: when behind, run the missed steps with the fixed delta to catch up.
+			// Steps beyond the catch up limit are dropped, the simulation can't keep up with the clock.
+			auto now = std::chrono::steady_clock::now();
+			uint64 target = static_cast<uint64>((now - mStartTime) / step_duration);
+			if (target > step + MAX_CATCH_UP_STEPS)
+			{
+				mSkippedCount += target - step - MAX_CATCH_UP_STEPS;
+				step = target - MAX_CATCH_UP_STEPS;
+			}
+
+			while (step < target && mRunning)
+			{
+				step++;
+				std::lock_guard<std::mutex> lock(mMutex);
+				double time = static_cast<double>(step) * period;
+				for (auto* simulation : mSimulations)
+					simulation->step(time, period);
+			}
+			next = mStartTime + step_duration * (step + 1);
+		}
+
+#ifdef _WIN32
+		if (timer != nullptr)
+			CloseHandle(timer);
+		else
+			timeEndPeriod(1);
+#endif
+	}
+}
@@ -0,0 +1,171 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+// External includes
+#include <nap/device.h>
+#include <utility/dllexport.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nap
+{
+	/**
+	 * Interface of a simulation that is advanced by a nap::SimulationClock
+	 */
+	class NAPAPI Simulation
+	{
+	public:
+		virtual ~Simulation() = default;
+
+		/**
+		 * Advances the simulation by a single fixed step, called from the clock thread.
+		 * @param time clock time at the end of the step in seconds
+		 * @param deltaTime fixed step in seconds
+		 */
+		virtual void step(double time, double deltaTime) = 0;
+	};
+
+
+	/**
+	 * Advances registered simulations at a fixed rate on its own thread, independent of the render loop.
+	 * Simulations publish their state as snapshots, see nap::SnapshotBuffer, which the main thread
+	 * interpolates at getRenderTime(). A slow frame therefore never stretches the simulation step,
+	 * motion is deterministic for a given input and frequency.
+	 *
+	 * When the thread wakes up late, the missed steps are run back to back to catch up with the clock,
+	 * up to MAX_CATCH_UP_STEPS per wake up. Only steps beyond that are dropped, see getSkippedCount().
+	 * On Windows a high resolution timer is used, the default timer granularity is coarser than a step.
+	 */
+	class NAPAPI SimulationClock : public Device
+	{
+		RTTI_ENABLE(Device)
+	public:
+		constexpr static uint64 MAX_CATCH_UP_STEPS = 16;			///< Maximum number of steps run in a single wake up
+
+		float mFrequency = 240.0f;									///< Property: 'Frequency' number of simulation steps per second
+
+		/**
+		 * Validates the frequency
+		 */
+		bool init(utility::ErrorState& errorState) override;
+
+		/**
+		 * Starts the simulation thread
+		 */
+		bool start(utility::ErrorState& errorState) override;
+
+		/**
+		 * Stops the simulation thread
+		 */
+		void stop() override;
+
+		/**
+		 * Adds a simulation, advanced from the next step on. Thread safe.
+		 * @param simulation the simulation to advance, must be removed before it is destroyed
+		 */
+		void addSimulation(Simulation& simulation);
+
+		/**
+		 * Removes a simulation, waits for a step in progress to complete. Thread safe.
+		 * @param simulation the simulation to remove
+		 */
+		void removeSimulation(Simulation& simulation);
+
+		/**
+		 * @return time since start in seconds
+		 */
+		double getTime() const;
+
+		/**
+		 * Snapshots are published at the end of every step: rendering one step behind the clock
+		 * guarantees there's a snapshot on both sides of the render time.
+		 * @return the time to sample snapshots at in seconds
+		 */
+		double getRenderTime() const								{ return getTime() - getPeriod(); }
+
+		/**
+		 * @return duration of a single step in seconds
+		 */
+		double getPeriod() const									{ return 1.0 / static_cast<double>(mFrequency); }
+
+		/**
+		 * @return number of steps that were dropped because the simulation fell behind more than MAX_CATCH_UP_STEPS
+		 */
+		uint64 getSkippedCount() const								{ return mSkippedCount.load(); }
+
+	private:
+		// Simulation thread
+		void run();
+
+		std::thread mThread;
+		std::mutex mMutex;
+		std::vector<Simulation*> mSimulations;
+		std::atomic<bool> mRunning = { false };
+		std::atomic<uint64> mSkippedCount = { 0 };
+		std::chrono::steady_clock::time_point mStartTime;
+	};
+
+
+	/**
+	 * Holds the two most recent snapshots of a simulation state, written by the simulation thread and
+	 * interpolated by the main thread. T must provide a static 'T lerp(const T& a, const T& b, double t)'.
+	 */
+	template<typename T>
+	class SnapshotBuffer final
+	{
+	public:
+		/**
+		 * Publishes a new snapshot, the oldest snapshot is discarded
+		 * @param time simulation time of the snapshot in seconds
+		 * @param state the new state
+		 */
+		void publish(double time, const T& state)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mPrevious = mCurrent;
+			mCurrent = { time, state };
+			mCount = mCount < 2 ? mCount + 1 : 2;
+		}
+
+		/**
+		 * Interpolates the state at the given time, clamped to the published snapshots.
+		 * @param time the time to sample at in seconds
+		 * @param state the interpolated state, untouched when nothing was published yet
+		 * @return if a snapshot was available
+		 */
+		bool sample(double time, T& state) const
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (mCount == 0)
+				return false;
+
+			if (mCount == 1 || mCurrent.mTime <= mPrevious.mTime)
+			{
+				state = mCurrent.mState;
+				return true;
+			}
+
+			double t = (time - mPrevious.mTime) / (mCurrent.mTime - mPrevious.mTime);
+			state = T::lerp(mPrevious.mState, mCurrent.mState, t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t));
+			return true;
+		}
+
+	private:
+		struct Snapshot
+		{
+			double mTime = 0.0;
+			T mState;
+		};
+
+		mutable std::mutex mMutex;
+		Snapshot mPrevious;
+		Snapshot mCurrent;
+		int mCount = 0;
+	};
+}
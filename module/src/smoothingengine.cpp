@@ -0,0 +1,113 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+// Local Includes
+#include "smoothingengine.h"
+
+// External Includes
+#include <algorithm>
+
+RTTI_BEGIN_CLASS(nap::SmoothingEngine)
+	RTTI_PROPERTY("Capacity",			&nap::SmoothingEngine::mCapacity,			nap::rtti::EPropertyMetaData::Default)
+RTTI_END_CLASS
+
+namespace nap
+{
+	// Smallest smooth time, prevents a division by zero
+	static constexpr float sMinSmoothTime = 0.0001f;
+
+
+	bool SmoothingEngine::init(utility::ErrorState& errorState)
+	{
+		if (!errorState.check(mCapacity >= 0, "%s: 'Capacity' can't be negative", mID.c_str()))
+			return false;
+
+		for (auto* array : { &mValues, &mVelocities, &mTargets, &mOmegas })
+			array->reserve(mCapacity);
+		mFree.reserve(mCapacity);
+		return true;
+	}
+
+
+	SmoothingEngine::Handle SmoothingEngine::add(float value, float smoothTime)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		Handle handle;
+		if (!mFree.empty())
+		{
+			handle.mIndex = mFree.back();
+			mFree.pop_back();
+		}
+		else
+		{
+			// Growing would move the storage the handles of other threads point into
+			if (mValues.size() >= static_cast<size_t>(mCapacity))
+				return handle;
+
+			handle.mIndex = static_cast<int>(mValues.size());
+			for (auto* array : { &mValues, &mVelocities, &mTargets, &mOmegas })
+				array->emplace_back(0.0f);
+		}
+
+		setValue(handle, value);
+		setSmoothTime(handle, smoothTime);
+		return handle;
+	}
+
+
+	void SmoothingEngine::remove(Handle& handle)
+	{
+		if (!handle.isValid())
+			return;
+
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		// A stiffness of 0 keeps the value where it is
+		mOmegas[handle.mIndex] = 0.0f;
+		mVelocities[handle.mIndex] = 0.0f;
+		mFree.emplace_back(handle.mIndex);
+		handle.mIndex = -1;
+	}
+
+
+	void SmoothingEngine::setValue(Handle handle, float value)
+	{
+		mValues[handle.mIndex] = value;
+		mTargets[handle.mIndex] = value;
+		mVelocities[handle.mIndex] = 0.0f;
+	}
+
+
+	void SmoothingEngine::setSmoothTime(Handle handle, float smoothTime)
+	{
+		mOmegas[handle.mIndex] = 2.0f / std::max(smoothTime, sMinSmoothTime);
+	}
+
+
+	void SmoothingEngine::step(double time, double deltaTime)
+	{
+		// Advanced once per clock time, by the first consumer. A time before the last step is a restarted clock
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (time == mTime)
+			return;
+		mTime = time;
+
+		// Critically damped spring, see math::smoothDamp, every array is walked once without branches
+		const float dt = static_cast<float>(deltaTime);
+		const int count = static_cast<int>(mValues.size());
+		float* values = mValues.data();
+		float* velocities = mVelocities.data();
+		const float* targets = mTargets.data();
+		const float* omegas = mOmegas.data();
+		for (int i = 0; i < count; i++)
+		{
+			float x = omegas[i] * dt;
+			float exp = 1.0f / (1.0f + x + 0.48f * x * x + 0.235f * x * x * x);
+			float change = values[i] - targets[i];
+			float temp = (velocities[i] + omegas[i] * change) * dt;
+			velocities[i] = (velocities[i] - omegas[i] * temp) * exp;
+			values[i] = targets[i] + (change + temp) * exp;
+		}
+	}
+}
@@ -0,0 +1,107 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+// External includes
+#include <nap/resource.h>
+#include <utility/dllexport.h>
+#include <vector>
+#include <mutex>
+
+namespace nap
+{
+	/**
+	 * Smooths many values towards their targets with a single critically damped step.
+	 *
+	 * Values are stored as structure of arrays: value, velocity, target and stiffness each live in their own
+	 * contiguous float array. A step is a single branch free loop over those arrays that the compiler vectorizes,
+	 * the cost of smoothing stays flat when the number of smoothed parameters grows.
+	 * The step is the same critically damped spring as math::SmoothOperator, without a maximum speed.
+	 *
+	 * Components add a value on init and keep the returned handle. Every consumer calls step() with the time of
+	 * the clock it is advanced by: the first call for a time advances all values, later calls for the same time
+	 * return right away. All consumers of an engine must therefore be advanced by the same clock, on the same thread.
+	 * Targets set after the step of a time are used from the next step on.
+	 *
+	 * Values are added and removed on the main thread while the clock thread steps, add(), remove() and step()
+	 * are therefore serialized. Storage is allocated once for 'Capacity' values and never moves, the accessors
+	 * of a handle don't lock.
+	 */
+	class NAPAPI SmoothingEngine : public Resource
+	{
+		RTTI_ENABLE(Resource)
+	public:
+		int mCapacity = 64;										///< Property: 'Capacity' number of values reserved on init
+
+		/**
+		 * Smoothed value
+		 */
+		struct Handle
+		{
+			int mIndex = -1;
+			bool isValid() const								{ return mIndex >= 0; }
+		};
+
+		/**
+		 * Reserves storage
+		 */
+		bool init(utility::ErrorState& errorState) override;
+
+		/**
+		 * Adds a value, reuses the slot of a removed value when available. Thread safe.
+		 * @param value initial value and target
+		 * @param smoothTime approximate time in seconds to reach the target
+		 * @return handle to the value, invalid when all 'Capacity' slots are in use
+		 */
+		Handle add(float value, float smoothTime);
+
+		/**
+		 * Removes a value, the handle becomes invalid. Thread safe.
+		 * @param handle the value to remove, reset on return
+		 */
+		void remove(Handle& handle);
+
+		/**
+		 * Advances all values once for the given time. Thread safe.
+		 * @param time clock time at the end of the step in seconds
+		 * @param deltaTime step in seconds
+		 */
+		void step(double time, double deltaTime);
+
+		/**
+		 * Sets the value a handle moves towards
+		 */
+		void setTarget(Handle handle, float target)				{ mTargets[handle.mIndex] = target; }
+
+		/**
+		 * Sets the value and target of a handle, stops its motion
+		 */
+		void setValue(Handle handle, float value);
+
+		/**
+		 * Sets the approximate time in seconds for a handle to reach its target
+		 */
+		void setSmoothTime(Handle handle, float smoothTime);
+
+		/**
+		 * @return the smoothed value of a handle
+		 */
+		float getValue(Handle handle) const						{ return mValues[handle.mIndex]; }
+
+		/**
+		 * @return number of values in use
+		 */
+		int getCount() const									{ std::lock_guard<std::mutex> lock(mMutex); return static_cast<int>(mValues.size() - mFree.size()); }
+
+	private:
+		std::vector<float> mValues;
+		std::vector<float> mVelocities;
+		std::vector<float> mTargets;
+		std::vector<float> mOmegas;								///< Spring stiffness: 2 / smooth time, 0 for removed values
+		std::vector<int> mFree;									///< Removed slots
+		double mTime = -1.0;									///< Clock time of the last step
+		mutable std::mutex mMutex;								///< Serializes add, remove and step
+	};
+}
@@ -0,0 +1,112 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+// Local Includes
+#include "tempoclock.h"
+
+// External Includes
+#include <algorithm>
+#include <cmath>
+
+RTTI_BEGIN_CLASS(nap::TempoClock)
+	RTTI_PROPERTY("Tempo",				&nap::TempoClock::mTempo,				nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("MinTempo",			&nap::TempoClock::mMinTempo,			nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("MaxTempo",			&nap::TempoClock::mMaxTempo,			nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("BeatsPerBar",		&nap::TempoClock::mBeatsPerBar,			nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("PhaseGain",			&nap::TempoClock::mPhaseGain,			nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("FrequencyGain",		&nap::TempoClock::mFrequencyGain,		nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("Timeout",			&nap::TempoClock::mTimeout,				nap::rtti::EPropertyMetaData::Default)
+RTTI_END_CLASS
+
+namespace nap
+{
+	// Smoothing of the jitter estimate per beat
+	static constexpr double sJitterSmoothing = 0.1;
+
+
+	// Floored modulo, beat indices can be negative
+	static int64 wrap(int64 value, int64 range)
+	{
+		int64 result = value % range;
+		return result < 0 ? result + range : result;
+	}
+
+
+	bool TempoClock::init(utility::ErrorState& errorState)
+	{
+		if (!errorState.check(mMinTempo > 0.0f && mMinTempo <= mTempo && mTempo <= mMaxTempo, "%s: 'Tempo' must be in range 'MinTempo' - 'MaxTempo'", mID.c_str()))
+			return false;
+
+		if (!errorState.check(mBeatsPerBar > 0, "%s: 'BeatsPerBar' must be higher than 0", mID.c_str()))
+			return false;
+
+		if (!errorState.check(mPhaseGain > 0.0f && mPhaseGain <= 1.0f && mFrequencyGain >= 0.0f && mFrequencyGain <= 1.0f,
+			"%s: 'PhaseGain' and 'FrequencyGain' must be in range 0-1", mID.c_str()))
+			return false;
+
+		mStartTime = std::chrono::steady_clock::now();
+		mPeriod = 60.0 / static_cast<double>(mTempo);
+		return true;
+	}
+
+
+	double TempoClock::getTime() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - mStartTime).count();
+	}
+
+
+	bool TempoClock::isLocked() const
+	{
+		return mLastInput >= 0.0 && getTime() - mLastInput <= static_cast<double>(mTimeout) * mPeriod;
+	}
+
+
+	void TempoClock::beat(double time, int beatInBar)
+	{
+		// Restart the grid on the first beat and after a pause of the source
+		if (mLastInput < 0.0 || time - mLastInput > static_cast<double>(mTimeout) * mPeriod)
+		{
+			mBeatIndex = static_cast<int64>(std::ceil(getBeatPosition(time)));
+			mBeatTime = time;
+			mJitter = 0.0;
+			mGridVersion++;
+		}
+		else
+		{
+			// Match to the nearest predicted beat, a beat within half a period of the reference corrects the reference
+			int64 beat = static_cast<int64>(std::llround(getBeatPosition(time)));
+			int64 elapsed = std::max<int64>(beat - mBeatIndex, 1);
+			double error = time - getBeatTime(beat);
+
+			// Second order loop: the period follows the error spread over the beats since the reference, the phase follows the error
+			double min_period = 60.0 / static_cast<double>(mMaxTempo);
+			double max_period = 60.0 / static_cast<double>(mMinTempo);
+			double predicted = getBeatTime(beat);
+			mPeriod = std::clamp(mPeriod + static_cast<double>(mFrequencyGain) * error / static_cast<double>(elapsed), min_period, max_period);
+			mBeatTime = predicted + static_cast<double>(mPhaseGain) * error;
+			mBeatIndex = beat;
+			mJitter += (std::abs(error) - mJitter) * sJitterSmoothing;
+		}
+
+		// Align the downbeat when the source reports the position in the bar
+		if (beatInBar >= 0)
+		{
+			int64 shift = wrap(static_cast<int64>(beatInBar) - mBeatIndex, mBeatsPerBar);
+			if (shift != 0)
+			{
+				mBeatIndex += shift;
+				mGridVersion++;
+			}
+		}
+		mLastInput = time;
+	}
+
+
+	int64 TempoClock::getNextBar(double time) const
+	{
+		int64 beat = static_cast<int64>(std::floor(getBeatPosition(time))) + 1;
+		return beat + wrap(-beat, mBeatsPerBar);
+	}
+}
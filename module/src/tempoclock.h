@@ -0,0 +1,107 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+// External includes
+#include <nap/resource.h>
+#include <utility/dllexport.h>
+#include <chrono>
+
+namespace nap
+{
+	/**
+	 * Tempo of an external source, tracked with a phase locked loop.
+	 *
+	 * Every incoming beat is matched to the nearest predicted beat. The phase error, the difference between
+	 * arrival and prediction, moves the beat grid by 'PhaseGain' and the beat period by 'FrequencyGain' of
+	 * the error. Arrival jitter is averaged out while the grid follows tempo changes of the source. Without
+	 * beats the clock keeps running at the last tempo, after 'Timeout' beats without input the next beat
+	 * restarts the grid. Beat indices are renumbered when the grid restarts or the source moves the downbeat,
+	 * getGridVersion() changes when that happens: beat indices taken before then no longer refer to the same beat.
+	 *
+	 * Beats are fed with beat(), see nap::TempoInputComponent. Main thread only.
+	 */
+	class NAPAPI TempoClock : public Resource
+	{
+		RTTI_ENABLE(Resource)
+	public:
+		float mTempo = 120.0f;										///< Property: 'Tempo' initial tempo in beats per minute
+		float mMinTempo = 60.0f;									///< Property: 'MinTempo' lower bound of the tracked tempo
+		float mMaxTempo = 200.0f;									///< Property: 'MaxTempo' upper bound of the tracked tempo
+		int mBeatsPerBar = 4;										///< Property: 'BeatsPerBar' number of beats in a bar
+		float mPhaseGain = 0.25f;									///< Property: 'PhaseGain' part of the phase error corrected per beat
+		float mFrequencyGain = 0.05f;								///< Property: 'FrequencyGain' part of the phase error applied to the beat period
+		float mTimeout = 8.0f;										///< Property: 'Timeout' beats without input before the grid restarts
+
+		/**
+		 * Validates the properties and starts the clock
+		 */
+		bool init(utility::ErrorState& errorState) override;
+
+		/**
+		 * Locks the grid to a beat that arrived at the given time
+		 * @param time arrival time in seconds, see getTime()
+		 * @param beatInBar position of the beat in the bar, -1 when unknown
+		 */
+		void beat(double time, int beatInBar = -1);
+
+		/**
+		 * @return time since init in seconds
+		 */
+		double getTime() const;
+
+		/**
+		 * @param time time in seconds
+		 * @return beat position at the given time, whole numbers are beats
+		 */
+		double getBeatPosition(double time) const					{ return static_cast<double>(mBeatIndex) + (time - mBeatTime) / mPeriod; }
+
+		/**
+		 * @param beat beat index
+		 * @return predicted time of the beat in seconds
+		 */
+		double getBeatTime(int64 beat) const						{ return mBeatTime + static_cast<double>(beat - mBeatIndex) * mPeriod; }
+
+		/**
+		 * @param time time in seconds
+		 * @return index of the first bar start after the given time
+		 */
+		int64 getNextBar(double time) const;
+
+		/**
+		 * @return duration of a beat in seconds
+		 */
+		double getPeriod() const									{ return mPeriod; }
+
+		/**
+		 * @return tempo in beats per minute
+		 */
+		double getTempo() const										{ return 60.0 / mPeriod; }
+
+		/**
+		 * @return average absolute phase error of incoming beats in seconds, the jitter of the source
+		 */
+		double getJitter() const									{ return mJitter; }
+
+		/**
+		 * @return if beats arrived within the timeout
+		 */
+		bool isLocked() const;
+
+		/**
+		 * @return incremented every time the beats are renumbered
+		 */
+		uint64 getGridVersion() const								{ return mGridVersion; }
+
+	private:
+		std::chrono::steady_clock::time_point mStartTime;
+		double mPeriod = 0.5;										///< Seconds per beat
+		double mBeatTime = 0.0;										///< Time of the reference beat
+		int64 mBeatIndex = 0;										///< Index of the reference beat
+		double mLastInput = -1.0;									///< Arrival time of the last beat, negative before the first
+		double mJitter = 0.0;
+		uint64 mGridVersion = 0;									///< Incremented when the beats are renumbered
+	};
+}
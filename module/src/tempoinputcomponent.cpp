@@ -0,0 +1,145 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+// Local Includes
+#include "tempoinputcomponent.h"
+
+// External Includes
+#include <entity.h>
+#include <oscinputcomponent.h>
+#include <nap/logger.h>
+#include <fstream>
+#include <sstream>
+
+RTTI_BEGIN_CLASS(nap::TempoInputComponent)
+	RTTI_PROPERTY("TempoClock",			&nap::TempoInputComponent::mTempoClock,			nap::rtti::EPropertyMetaData::Required)
+	RTTI_PROPERTY("BundleReceiver",		&nap::TempoInputComponent::mBundleReceiver,		nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY("BeatAddress",		&nap::TempoInputComponent::mBeatAddress,		nap::rtti::EPropertyMetaData::Default)
+	RTTI_PROPERTY_FILELINK("BeatFile",	&nap::TempoInputComponent::mBeatFile,			nap::rtti::EPropertyMetaData::Default, nap::rtti::EPropertyFileType::Any)
+	RTTI_PROPERTY("Verbose",			&nap::TempoInputComponent::mVerbose,			nap::rtti::EPropertyMetaData::Default)
+RTTI_END_CLASS
+
+RTTI_BEGIN_CLASS_NO_DEFAULT_CONSTRUCTOR(nap::TempoInputComponentInstance)
+	RTTI_CONSTRUCTOR(nap::EntityInstance&, nap::Component&)
+RTTI_END_CLASS
+
+namespace nap
+{
+	void TempoInputComponent::getDependentComponents(std::vector<rtti::TypeInfo>& components) const
+	{
+		components.emplace_back(RTTI_OF(nap::OSCInputComponent));
+	}
+
+
+	bool TempoInputComponentInstance::init(utility::ErrorState& errorState)
+	{
+		mResource = getComponent<TempoInputComponent>();
+		mClock = mResource->mTempoClock.get();
+
+		// The file replaces the external source
+		if (!mResource->mBeatFile.empty())
+			return loadBeats(mResource->mBeatFile, errorState);
+
+		// Beats are timestamped on the receive thread, not when the main thread gets to them
+		if (mResource->mBundleReceiver != nullptr)
+		{
+			mReceiver = mResource->mBundleReceiver.get();
+			mReceiver->addStampedAddress(mResource->mBeatAddress);
+			return true;
+		}
+
+		OSCInputComponentInstance* osc_input = getEntityInstance()->findComponent<OSCInputComponentInstance>();
+		if (!errorState.check(osc_input != nullptr, "%s: missing OSCInputComponent", mID.c_str()))
+			return false;
+
+		osc_input->messageReceived.connect(eventReceivedSlot);
+		return true;
+	}
+
+
+	bool TempoInputComponentInstance::loadBeats(const std::string& path, utility::ErrorState& errorState)
+	{
+		std::ifstream file(path);
+		if (!errorState.check(file.is_open(), "%s: unable to open beat file %s", mID.c_str(), path.c_str()))
+			return false;
+
+		// Beat time, optionally followed by the position in the bar
+		std::string line;
+		while (std::getline(file, line))
+		{
+			std::istringstream stream(line);
+			Beat beat;
+			if (!(stream >> beat.mTime))
+				continue;
+			if (!(stream >> beat.mBeatInBar))
+				beat.mBeatInBar = -1;
+
+			if (!errorState.check(mBeats.empty() || beat.mTime > mBeats.back().mTime, "%s: beat times in %s must increase", mID.c_str(), path.c_str()))
+				return false;
+			mBeats.emplace_back(beat);
+		}
+
+		if (!errorState.check(mBeats.size() >= 2, "%s: %s must hold at least 2 beats", mID.c_str(), path.c_str()))
+			return false;
+
+		mFileStart = mClock->getTime() - mBeats.front().mTime;
+		return true;
+	}
+
+
+	void TempoInputComponentInstance::update(double deltaTime)
+	{
+		// Map the arrival time of the receiver to the clock, both are steady clocks with a different start
+		if (mReceiver != nullptr)
+		{
+			mReceiver->popArrivals(mArrivals);
+			double offset = mClock->getTime() - mReceiver->getTime();
+			for (const auto& arrival : mArrivals)
+				feedBeat(*arrival.mEvent, arrival.mTime + offset);
+			mArrivals.clear();
+			return;
+		}
+
+		if (mBeats.empty())
+			return;
+
+		// Loops after the last beat, one average interval later
+		double time = mClock->getTime();
+		double length = (mBeats.back().mTime - mBeats.front().mTime) * static_cast<double>(mBeats.size()) / static_cast<double>(mBeats.size() - 1);
+		while (mFileStart + mBeats[mNextBeat].mTime <= time)
+		{
+			const auto& beat = mBeats[mNextBeat];
+			mClock->beat(mFileStart + beat.mTime, beat.mBeatInBar);
+			if (++mNextBeat == mBeats.size())
+			{
+				mNextBeat = 0;
+				mFileStart += length;
+			}
+		}
+	}
+
+
+	void TempoInputComponentInstance::onEventReceived(const OSCEvent& event)
+	{
+		if (event.getAddress() == mResource->mBeatAddress)
+			feedBeat(event, mClock->getTime());
+	}
+
+
+	void TempoInputComponentInstance::feedBeat(const OSCEvent& event, double time)
+	{
+		int beat_in_bar = -1;
+		if (event.getCount() > 0)
+		{
+			if (const auto* v = event[0].get<OSCInt>())
+				beat_in_bar = v->mValue;
+			else if (const auto* v = event[0].get<OSCFloat>())
+				beat_in_bar = static_cast<int>(v->mValue);
+		}
+
+		mClock->beat(time, beat_in_bar);
+		if (mResource->mVerbose)
+			nap::Logger::info("%s: beat %d, tempo %.1f bpm, jitter %.1f ms", mID.c_str(), beat_in_bar, mClock->getTempo(), mClock->getJitter() * 1000.0);
+	}
+}
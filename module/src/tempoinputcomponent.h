@@ -0,0 +1,99 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/. */
+
+#pragma once
+
+// External includes
+#include <component.h>
+#include <nap/signalslot.h>
+#include <nap/resourceptr.h>
+#include <oscevent.h>
+#include <vector>
+
+// Local includes
+#include "oscbundlereceiver.h"
+#include "tempoclock.h"
+
+namespace nap
+{
+	// Forward Declare
+	class TempoInputComponentInstance;
+
+	/**
+	 * Feeds beats into a tempo clock.
+	 *
+	 * Beats arrive as OSC messages at 'BeatAddress', with an optional int argument that holds the position of the
+	 * beat in the bar. With a 'BundleReceiver' beats are timestamped on its receive thread when they arrive.
+	 * Otherwise they are taken from the OSC input component of the entity and timestamped when the main thread
+	 * dispatches them, up to a frame late. When a 'BeatFile' is given, beats are read from the file instead and replayed in a loop:
+	 * a stand-in for an external clock during rehearsals. The file holds a beat time in seconds per line,
+	 * optionally followed by the position in the bar.
+	 */
+	class NAPAPI TempoInputComponent : public Component
+	{
+		RTTI_ENABLE(Component)
+		DECLARE_COMPONENT(TempoInputComponent, TempoInputComponentInstance)
+	public:
+		/**
+		 * Get a list of all component types that this component is dependent on (i.e. must be initialized before this one)
+		 * @param components the components this object depends on
+		 */
+		void getDependentComponents(std::vector<rtti::TypeInfo>& components) const override;
+
+		ResourcePtr<TempoClock> mTempoClock;						///< Property: 'TempoClock' the clock to feed
+		ResourcePtr<OSCBundleReceiver> mBundleReceiver;				///< Property: 'BundleReceiver' optional receiver that timestamps beats on arrival
+		std::string mBeatAddress = "/beat";							///< Property: 'BeatAddress' OSC address of beat messages
+		std::string mBeatFile;										///< Property: 'BeatFile' optional file with beat times, replaces OSC input
+		bool mVerbose = false;										///< Property: 'Verbose' log every beat
+	};
+
+
+	/**
+	 * Receives beats from the bundle receiver or the OSC input component of the same entity, or replays a beat file
+	 */
+	class NAPAPI TempoInputComponentInstance : public ComponentInstance
+	{
+		RTTI_ENABLE(ComponentInstance)
+	public:
+		TempoInputComponentInstance(EntityInstance& entity, Component& resource) : ComponentInstance(entity, resource) { }
+
+		/**
+		 * Connects to the OSC input or loads the beat file
+		 */
+		bool init(utility::ErrorState& errorState) override;
+
+		/**
+		 * Feeds the beats that arrived at the bundle receiver, or the beats of the file that are due
+		 * @param deltaTime time in between frames in seconds
+		 */
+		void update(double deltaTime) override;
+
+	private:
+		// Beat of the file
+		struct Beat
+		{
+			double mTime = 0.0;
+			int mBeatInBar = -1;
+		};
+
+		// Feeds a beat message that arrived at the given clock time into the clock
+		void feedBeat(const OSCEvent& event, double time);
+
+		// Feeds a beat message dispatched by the OSC input component into the clock
+		void onEventReceived(const OSCEvent& event);
+
+		// Loads the beat file
+		bool loadBeats(const std::string& path, utility::ErrorState& errorState);
+
+		Slot<const OSCEvent&> eventReceivedSlot = { this, &TempoInputComponentInstance::onEventReceived };
+
+		TempoInputComponent* mResource = nullptr;
+		TempoClock* mClock = nullptr;
+		OSCBundleReceiver* mReceiver = nullptr;
+		std::vector<OSCBundleReceiver::Scheduled> mArrivals;		///< Beats taken from the bundle receiver, reused every frame
+		std::vector<Beat> mBeats;
+		size_t mNextBeat = 0;
+		double mFileStart = 0.0;									///< Clock time of the first beat of the current loop
+	};
+}
@@ -10,12 +10,126 @@
 #include <perspcameracomponent.h>
 #include <rendertotexturecomponent.h>
 #include <renderbloomcomponent.h>
+#include <renderbloompyramidcomponent.h>
 #include <computecomponent.h>
-#include <depthsorter.h>
+#include <renderablemeshcomponent.h>
+#include <renderlinecomponent.h>
+#include <transformcomponent.h>
 #include <sdlhelpers.h>
+#include <nap/logger.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
 
 namespace nap 
 {    
+    // Consumer of all passes that only feed the preview window
+    static const std::string sPreviewConsumer = "Preview";
+
+    // Consumer of the control window
+    static const std::string sGUIConsumer = "GUI";
+
+    // Preview quality steps in order of degradation, see LoveLightsApp::applyQuality()
+    static const std::array<const char*, 3> sQualitySteps = { "Bloom levels", "Bloom radius", "Chromatic aberration" };
+
+
+    // PCI vendor ids
+    static constexpr uint32 sVendorNVIDIA = 0x10DE;
+    static constexpr uint32 sVendorAMD = 0x1002;
+    static constexpr uint32 sVendorIntel = 0x8086;
+    static constexpr uint32 sVendorMesa = 0x10005;                  ///< VK_VENDOR_ID_MESA, software devices
+
+
+    // Logs if the driver persists compiled pipelines in the project cache, see setupPipelineCache() in main.cpp.
+    // Only the NVIDIA driver and Mesa read the cache location, other drivers are reported as such or as unknown.
+    static void logPipelineCache(const VkPhysicalDeviceProperties& properties)
+    {
+        bool persistent = properties.vendorID == sVendorNVIDIA;
+        bool known = true;
+#if !defined(_WIN32) && !defined(__APPLE__)
+        // Intel and software devices are Mesa on Linux, AMD devices only when the driver is RADV
+        if (properties.vendorID == sVendorIntel || properties.vendorID == sVendorMesa)
+            persistent = true;
+        else if (properties.vendorID == sVendorAMD)
+            persistent = std::strstr(properties.deviceName, "RADV") != nullptr;
+        else
+            known = persistent;
+#endif
+        if (persistent)
+            nap::Logger::info("Driver pipeline cache: cache/pipelines (%s)", properties.deviceName);
+        else if (known)
+            nap::Logger::warn("Driver of %s doesn't use cache/pipelines, pipelines persist only in its own cache, if any", properties.deviceName);
+        else
+            nap::Logger::info("Driver pipeline cache: unknown if the driver of %s uses cache/pipelines", properties.deviceName);
+    }
+
+
+    // Renderable components of a pass, filtered by mask and camera when the graph is built.
+    // Sorted in place and drawn directly: unlike RenderService::renderObjects() a frame doesn't allocate.
+    struct DrawList
+    {
+        std::vector<std::pair<RenderableComponentInstance*, TransformComponentInstance*>> mItems;
+        bool mSortByZ = false;                  ///< Back to front on z, see sorter::sortObjectsByZ()
+    };
+
+
+    // Creates the draw list of a pass
+    static DrawList createDrawList(const std::vector<RenderableComponentInstance*>& comps, CameraComponentInstance& camera, RenderMask mask, bool sortByZ)
+    {
+        DrawList list;
+        list.mSortByZ = sortByZ;
+        for (auto* comp : comps)
+        {
+            if (comp->includesMask(mask) && comp->isSupported(camera))
+                list.mItems.emplace_back(comp, comp->getEntityInstance()->findComponent<TransformComponentInstance>());
+        }
+        return list;
+    }
+
+
+    // Draws a list into the target that is being recorded
+    static void drawObjects(RenderService& renderService, IRenderTarget& target, CameraComponentInstance& camera, DrawList& list)
+    {
+        if (list.mSortByZ)
+        {
+            std::sort(list.mItems.begin(), list.mItems.end(), [](const auto& a, const auto& b)
+            {
+                float a_z = a.second != nullptr ? a.second->getGlobalTransform()[3].z : 0.0f;
+                float b_z = b.second != nullptr ? b.second->getGlobalTransform()[3].z : 0.0f;
+                return a_z < b_z;
+            });
+        }
+
+        camera.setRenderTargetSize(target.getBufferSize());
+        const glm::mat4 projection = camera.getRenderProjectionMatrix();
+        const glm::mat4 view = camera.getViewMatrix();
+        VkCommandBuffer command_buffer = renderService.getCurrentCommandBuffer();
+        for (auto& item : list.mItems)
+        {
+            if (item.first->isVisible())
+                item.first->draw(target, command_buffer, view, projection);
+        }
+    }
+
+
+    // Advances the time since the last render and returns if a new render is due, at most once per frame.
+    // Time left over is carried to keep the average rate, 0 fps renders every frame.
+    static bool isRenderDue(double& elapsed, float framesPerSecond, double deltaTime)
+    {
+        if (framesPerSecond <= 0.0f)
+            return true;
+
+        elapsed += deltaTime;
+        double interval = 1.0 / static_cast<double>(framesPerSecond);
+        if (elapsed < interval)
+            return false;
+
+        // Don't accumulate debt after a hitch
+        elapsed = elapsed - interval < interval ? elapsed - interval : 0.0;
+        return true;
+    }
+
+
     bool LoveLightsApp::init(utility::ErrorState& errorState)
     {
 		// Retrieve services
@@ -71,16 +185,28 @@ namespace nap
 		mRenderCameraEntity 	= mScene->findEntity("RenderCameraEntity");
         mPlaylistEntity         = mScene->findEntity("PlaylistEntity");
 
+        logPipelineCache(mRenderService->getPhysicalDeviceProperties());
+
         // Connect hot reload slot
         mResourceManager->mPostResourcesLoadedSignal.connect(mHotReloadSlot);
         onReset();
 
+		// The app is created before the project is loaded
+		nap::Logger::info("Resources loaded and app initialized in %.1f ms", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mLaunchTime).count());
 		return true;
     }
 
 
     void LoveLightsApp::onReset()
     {
+        // Resolve render passes for the (new) scene
+        buildRenderGraph();
+        createPipelines();
+
+        // Start at full quality, components are recreated on hot reload
+        mQualityGovernor.reset();
+        applyQuality();
+
         if (mStencilTarget == nullptr || mStencilTarget->mColorTexture == nullptr)
             return;
 
@@ -93,6 +219,257 @@ namespace nap
     }
 
 
+    void LoveLightsApp::buildRenderGraph()
+    {
+        mRenderGraph.clear();
+        mBloom = nullptr;
+        mBloomPyramid = nullptr;
+        mAberration = nullptr;
+
+        // Measures the GPU time of a pass, must be recorded outside of a render pass
+        uint timer_scope_count = 0;
+        auto add_timed_pass = [this, &timer_scope_count](const std::string& name, RenderGraph::PassFunction function)
+        {
+            uint scope = timer_scope_count++;
+            auto& pass = mRenderGraph.addPass(name, [this, scope, function = std::move(function)]()
+            {
+                if (mGPUTimer != nullptr)
+                    mGPUTimer->begin(scope);
+                function();
+                if (mGPUTimer != nullptr)
+                    mGPUTimer->end(scope);
+            }, sPreviewConsumer);
+            pass.mTimerScope = static_cast<int>(scope);
+        };
+
+        // Compute
+        std::vector<ComputeComponentInstance*> compute_comps;
+        mComputeEntity->getComponentsOfTypeRecursive<ComputeComponentInstance>(compute_comps);
+
+        mRenderGraph.addStage("Compute",
+            [this]() { return mRenderService->beginComputeRecording(); },
+            [this]() { mRenderService->endComputeRecording(); });
+        mRenderGraph.addPass("Compute", [this, comps = std::move(compute_comps)]() { mRenderService->computeObjects(comps); });
+
+        // Headless recording. Rendering always happens after compute.
+        mRenderGraph.addStage("Headless",
+            [this]() { return mRenderService->beginHeadlessRecording(); },
+            [this]() { mRenderService->endHeadlessRecording(); });
+
+        // The world entity holds all visible renderable components in the scene, rendered with the perspective camera
+        std::vector<RenderableComponentInstance*> render_comps;
+        mWorldEntity->getComponentsOfTypeRecursive<RenderableComponentInstance>(render_comps);
+        auto* cam = &mCameraEntity->getComponent<CameraComponentInstance>();
+
+        // Render stencil geometry to stencil target
+        if (mStencilTarget != nullptr)
+        {
+            add_timed_pass("Stencil", [this, cam, list = createDrawList(render_comps, *cam, mRenderService->getRenderMask("Stencil"), true)]() mutable
+            {
+                mStencilTarget->beginRendering();
+                drawObjects(*mRenderService, *mStencilTarget, *cam, list);
+                mStencilTarget->endRendering();
+            });
+        }
+
+        // Offscreen color pass -> Render all available geometry to the color texture bound to the render target.
+        auto mask = mRenderService->getRenderMask("Default");
+        add_timed_pass("Color", [this, cam, list = createDrawList(render_comps, *cam, (mask != 0) ? mask : mask::all, true)]() mutable
+        {
+            mColorTarget->beginRendering();
+            drawObjects(*mRenderService, *mColorTarget, *cam, list);
+            mColorTarget->endRendering();
+        });
+
+        // Invoke draw() on components in render entity in order
+        if (mRenderEntity != nullptr)
+        {
+            std::vector<RenderableComponentInstance*> comps;
+            mRenderEntity->getComponentsOfTypeRecursive(comps);
+            for (auto* comp : comps)
+            {
+                // Call known post-processing components directly
+                RenderGraph::PassFunction draw;
+                if (comp->get_type().is_derived_from(RTTI_OF(RenderToTextureComponentInstance)))
+                {
+                    // Chromatic aberration of the composite, lowered by the quality governor
+                    auto* rtt = static_cast<RenderToTextureComponentInstance*>(comp);
+                    auto* ubo = mAberration == nullptr ? rtt->getMaterialInstance().getOrCreateUniform("UBO") : nullptr;
+                    auto* aberration = ubo != nullptr ? ubo->getOrCreateUniform<UniformFloatInstance>("abberation") : nullptr;
+                    if (aberration != nullptr)
+                    {
+                        mAberration = aberration;
+                        mAberrationValue = aberration->getValue();
+                    }
+                    draw = [rtt]() { rtt->draw(); };
+                }
+                else if (comp->get_type().is_derived_from(RTTI_OF(RenderBloomComponentInstance)))
+                {
+                    mBloom = comp;
+                    draw = [c = static_cast<RenderBloomComponentInstance*>(comp)]() { c->draw(); };
+                }
+                else if (comp->get_type().is_derived_from(RTTI_OF(RenderBloomPyramidComponentInstance)))
+                {
+                    mBloomPyramid = comp;
+                    mUseBloomPyramid = comp->isVisible();
+                    draw = [c = static_cast<RenderBloomPyramidComponentInstance*>(comp)]() { c->draw(); };
+                }
+                else
+                {
+                    nap::Logger::warn("%s: no draw call for %s in the render graph, skipped", comp->mID.c_str(), comp->get_type().get_name().data());
+                    continue;
+                }
+
+                add_timed_pass(comp->mID, [comp, draw = std::move(draw)]()
+                {
+                    if (comp->isVisible())
+                        draw();
+                });
+            }
+        }
+
+        // Composite into the main render window
+        mRenderGraph.addStage("Window",
+            [this]() { if (!mRenderService->beginRecording(*mRenderWindow)) return false; mRenderWindow->beginRendering(); return true; },
+            [this]() { mRenderWindow->endRendering(); mRenderService->endRecording(); }, sPreviewConsumer);
+        {
+            std::vector<RenderableComponentInstance*> comps;
+            mCompositeEntity->getComponentsOfTypeRecursive(comps);
+            auto* render_cam = &mRenderCameraEntity->getComponent<CameraComponentInstance>();
+            mRenderGraph.addPass("Composite", [this, render_cam, list = createDrawList(comps, *render_cam, mask::all, false)]() mutable
+            {
+                drawObjects(*mRenderService, *mRenderWindow, *render_cam, list);
+            });
+        }
+
+        // Control window GUI
+        mRenderGraph.addStage("ControlWindow",
+            [this]() { if (!mRenderService->beginRecording(*mControlWindow)) return false; mControlWindow->beginRendering(); return true; },
+            [this]() { mControlWindow->endRendering(); mRenderService->endRecording(); }, sGUIConsumer);
+        mRenderGraph.addPass("GUI", [this]() { mGuiService->draw(); });
+
+        // GPU time of the headless passes
+        utility::ErrorState error_state;
+        mGPUTimer = std::make_unique<GPUTimer>(*mRenderService);
+        if (!mGPUTimer->init(timer_scope_count, error_state))
+        {
+            nap::Logger::warn("GPU pass timing unavailable: %s", error_state.toString().c_str());
+            mGPUTimer.reset();
+        }
+    }
+
+
+    void LoveLightsApp::createPipelines()
+    {
+        auto start = std::chrono::steady_clock::now();
+        utility::ErrorState error_state;
+        int count = 0;
+
+        // World geometry is rendered into the color and stencil target
+        std::vector<const IRenderTarget*> targets = { mColorTarget.get() };
+        if (mStencilTarget != nullptr)
+            targets.emplace_back(mStencilTarget.get());
+
+        std::vector<RenderableComponentInstance*> render_comps;
+        mWorldEntity->getComponentsOfTypeRecursive<RenderableComponentInstance>(render_comps);
+        for (const auto* target : targets)
+        {
+            for (auto* comp : render_comps)
+            {
+                bool created = false;
+                if (comp->get_type().is_derived_from(RTTI_OF(RenderLineComponentInstance)))
+                {
+                    created = static_cast<RenderLineComponentInstance*>(comp)->createPipeline(*target, error_state);
+                }
+                else if (comp->get_type().is_derived_from(RTTI_OF(RenderableMeshComponentInstance)))
+                {
+                    auto* mesh_comp = static_cast<RenderableMeshComponentInstance*>(comp);
+                    auto pipeline = mRenderService->getOrCreatePipeline(*target, mesh_comp->getRenderableMesh().getMesh(), mesh_comp->getMaterialInstance(), error_state);
+                    created = pipeline.mPipeline != VK_NULL_HANDLE;
+                }
+                else
+                {
+                    continue;
+                }
+
+                if (!created)
+                {
+                    nap::Logger::warn("%s: unable to create pipeline: %s", comp->mID.c_str(), error_state.toString().c_str());
+                    continue;
+                }
+                count++;
+            }
+        }
+
+        // Compute
+        std::vector<ComputeComponentInstance*> compute_comps;
+        mComputeEntity->getComponentsOfTypeRecursive<ComputeComponentInstance>(compute_comps);
+        for (auto* comp : compute_comps)
+        {
+            auto pipeline = mRenderService->getOrCreateComputePipeline(comp->getMaterialInstance(), error_state);
+            if (pipeline.mPipeline == VK_NULL_HANDLE)
+            {
+                nap::Logger::warn("%s: unable to create pipeline: %s", comp->mID.c_str(), error_state.toString().c_str());
+                continue;
+            }
+            count++;
+        }
+
+        // Post-processing components don't expose their meshes and materials: record their passes once in a warm-up
+        // frame, the driver creates their pipelines. Only offscreen targets are drawn, overwritten by the first frame.
+        // The window isn't recorded: the warm-up also runs on hot reload and would present undrawn targets, the
+        // composite pipeline is created by the first frame. The bloom pyramid creates its pipelines on init.
+        std::vector<RenderableComponentInstance*> post_comps;
+        if (mRenderEntity != nullptr)
+            mRenderEntity->getComponentsOfTypeRecursive(post_comps);
+
+        mRenderService->beginFrame();
+        if (mRenderService->beginHeadlessRecording())
+        {
+            for (auto* comp : post_comps)
+            {
+                if (comp->get_type().is_derived_from(RTTI_OF(RenderToTextureComponentInstance)))
+                    static_cast<RenderToTextureComponentInstance*>(comp)->draw();
+                else if (comp->get_type().is_derived_from(RTTI_OF(RenderBloomComponentInstance)))
+                    static_cast<RenderBloomComponentInstance*>(comp)->draw();
+                else
+                    continue;
+                count++;
+            }
+            mRenderService->endHeadlessRecording();
+        }
+        mRenderService->endFrame();
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        nap::Logger::info("Created %d pipelines in %.2f ms", count, ms);
+    }
+
+
+    void LoveLightsApp::applyQuality()
+    {
+        int level = mQualityGovernor.getLevel();
+
+        // Bloom levels: the pyramid at half its levels replaces the gaussian bloom.
+        // Bloom radius: a single level, skipping the half resolution upsample.
+        if (mBloomPyramid != nullptr)
+        {
+            auto* pyramid = static_cast<RenderBloomPyramidComponentInstance*>(mBloomPyramid);
+            bool reduce = level >= 1;
+            int count = pyramid->getLevelCount();
+            pyramid->setActiveLevelCount(level >= 2 ? 1 : (reduce ? count / 2 : count));
+
+            bool use_pyramid = mUseBloomPyramid || (reduce && mBloom != nullptr);
+            pyramid->setVisible(use_pyramid);
+            if (mBloom != nullptr)
+                mBloom->setVisible(!use_pyramid);
+        }
+
+        // Chromatic aberration samples the color texture three times
+        if (mAberration != nullptr)
+            mAberration->setValue(level >= 3 ? 0.0f : mAberrationValue);
+    }
+
+
     // Called when the window is going to renderco
     void LoveLightsApp::render()
     {
@@ -101,93 +478,59 @@ namespace nap
 		// Multiple frames are in flight at the same time, but if the graphics load is heavy the system might wait here to ensure resources are available.
 		mRenderService->beginFrame();
 
-    	// Compute
-    	if (mRenderService->beginComputeRecording())
-    	{
-    		std::vector<ComputeComponentInstance*> compute_comps;
-    		mComputeEntity->getComponentsOfTypeRecursive<ComputeComponentInstance>(compute_comps);
-    		mRenderService->computeObjects(compute_comps);
-    		mRenderService->endComputeRecording();
-    	}
-
-		// Begin recording the render commands for the offscreen render target. Rendering always happens after compute.
-		// This prepares a command buffer and starts a render pass.
-		if (mRenderService->beginHeadlessRecording())
-		{
-			// The world entity holds all visible renderable components in the scene.
-			std::vector<RenderableComponentInstance*> render_comps;
-			mWorldEntity->getComponentsOfTypeRecursive<RenderableComponentInstance>(render_comps);
-
-			// Get Perspective camera to render with
-			auto& cam = mCameraEntity->getComponent<CameraComponentInstance>();
-
-			// Render stencil geometry to stencil target
-			if (mStencilTarget != nullptr)
-			{
-				auto stencil_mask = mRenderService->getRenderMask("Stencil");
-				mStencilTarget->beginRendering();
-				mRenderService->renderObjects(*mStencilTarget, cam, render_comps, stencil_mask);
-				mStencilTarget->endRendering();
-			}
+		// Fetch GPU time of the passes recorded the last time this frame was used
+		if (mGPUTimer != nullptr)
+			mGPUTimer->resolve();
 
-			// Offscreen color pass -> Render all available geometry to the color texture bound to the render target.
-			mColorTarget->beginRendering();
-			{
-				auto mask = mRenderService->getRenderMask("Default");
-				mRenderService->renderObjects(*mColorTarget, cam, render_comps, std::bind(&sorter::sortObjectsByZ, std::placeholders::_1), (mask != 0) ? mask : mask::all);
-			}
-			mColorTarget->endRendering();
+		// Record all stages and passes, resolved in buildRenderGraph()
+		mRenderGraph.execute();
 
-			// Invoke draw() on components in render entity in order
-			if (mRenderEntity != nullptr)
+		// Govern preview quality using the cost of frames that rendered the preview: CPU time up to submission
+		// and GPU time of the headless passes. The budget is the compute and laser tick, which is never degraded.
+		const auto* preview_stage = mRenderGraph.findStage("Window");
+		if (mAppState->mGovernQuality && preview_stage != nullptr && preview_stage->mRan && mAppState->mFramesPerSecond > 0.0f)
+		{
+			double cpu_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mFrameStart).count();
+			// Only preview passes that ran this frame and were measured in the resolved frame,
+			// culled passes and the control window GUI aren't preview cost
+			double gpu_ms = 0.0;
+			if (mGPUTimer != nullptr)
 			{
-				std::vector<RenderableComponentInstance*> comps;
-				mRenderEntity->getComponentsOfTypeRecursive(comps);
-
-				for (auto& comp : comps)
+				for (const auto& stage : mRenderGraph.getStages())
 				{
-					if (!comp->isVisible())
+					if (!stage.mRan)
 						continue;
 
-					// Find draw method
-					auto draw_method = rtti::findMethodRecursive(comp->get_type(), "draw");
-					if (!draw_method.is_valid())
-						continue;
-
-					// Invoke draw method
-					draw_method.invoke(*comp);
+					for (const auto& pass : stage.mPasses)
+					{
+						if (pass.mRan && pass.mTimerScope >= 0 && pass.mConsumer == sPreviewConsumer && mGPUTimer->isMeasured(pass.mTimerScope))
+							gpu_ms += mGPUTimer->getMilliseconds(pass.mTimerScope);
+					}
 				}
 			}
 
-			// End headless recording
-			mRenderService->endHeadlessRecording();
+			int level = mQualityGovernor.getLevel();
+			double budget = 1000.0 / static_cast<double>(mAppState->mFramesPerSecond);
+			if (mQualityGovernor.update(getCore().getElapsedTime(), std::max(cpu_ms, gpu_ms), budget))
+			{
+				applyQuality();
+				if (mQualityGovernor.getLevel() > level)
+					nap::Logger::warn("Preview quality lowered to level %d, reduced %s: frame cost %.2f ms, budget %.2f ms",
+						mQualityGovernor.getLevel(), sQualitySteps[level], mQualityGovernor.getAverageCost(), budget);
+				else
+					nap::Logger::info("Preview quality raised to level %d, restored %s: frame cost %.2f ms, budget %.2f ms",
+						mQualityGovernor.getLevel(), sQualitySteps[level - 1], mQualityGovernor.getAverageCost(), budget);
+			}
 		}
 
-		// Begin recording the render commands for the main render window
-		if (mRenderService->beginRecording(*mRenderWindow))
+		// Close the GUI frame when the control window wasn't drawn this frame
+		const auto* gui_stage = mRenderGraph.findStage("ControlWindow");
+		if (gui_stage != nullptr && !gui_stage->mRan)
 		{
-			// Begin render pass
-			mRenderWindow->beginRendering();
-
-			// Get Perspective camera to render with
-			auto& cam = mRenderCameraEntity->getComponent<CameraComponentInstance>();
-
-			std::vector<RenderableComponentInstance*> comps;
-			mCompositeEntity->getComponentsOfTypeRecursive(comps);
-			mRenderService->renderObjects(*mRenderWindow, cam, comps);
-            mRenderWindow->endRendering();
-            mRenderService->endRecording();
+			mGuiService->selectWindow(mControlWindow);
+			ImGui::EndFrame();
 		}
 
-        // Begin recording the render commands for the control window
-        if (mRenderService->beginRecording(*mControlWindow))
-        {
-            mControlWindow->beginRendering();
-            mGuiService->draw();
-            mControlWindow->endRendering();
-            mRenderService->endRecording();
-        }
-
 		// Proceed to next frame
 		mRenderService->endFrame();
     }
@@ -195,6 +538,19 @@ namespace nap
 
     void LoveLightsApp::windowMessageReceived(WindowEventPtr windowEvent)
     {
+		// Track visibility of the preview window, SDL does not report occlusion by other windows
+		if (windowEvent->mWindow == static_cast<int>(mRenderWindow->getNumber()))
+		{
+			rtti::TypeInfo type = windowEvent->get_type();
+			if (type.is_derived_from(RTTI_OF(WindowMinimizedEvent)))
+				mPreviewMinimized = true;
+			else if (type.is_derived_from(RTTI_OF(WindowRestoredEvent)) || type.is_derived_from(RTTI_OF(WindowMaximizedEvent)))
+				mPreviewMinimized = false;
+			else if (type.is_derived_from(RTTI_OF(WindowHiddenEvent)))
+				mPreviewHidden = true;
+			else if (type.is_derived_from(RTTI_OF(WindowShownEvent)))
+				mPreviewHidden = false;
+		}
 		mRenderService->addEvent(std::move(windowEvent));
     }
 
@@ -245,11 +601,32 @@ namespace nap
 
     void LoveLightsApp::update(double deltaTime)
     {
+		mFrameStart = std::chrono::steady_clock::now();
+		if (!mStarted)
+		{
+			nap::Logger::info("First frame after %.1f ms", std::chrono::duration<double, std::milli>(mFrameStart - mLaunchTime).count());
+			mStarted = true;
+		}
+
 		// Use a default input router to forward input events (recursively) to all input components in the scene
 		// This is explicit because we don't know what entity should handle the events from a specific window.
 		DefaultInputRouter input_router(true);
 		mInputService->processWindowEvents(*mRenderWindow, input_router, { &mScene->getRootEntity() });
 
+		// Cull the preview chain when nobody is watching, laser and compute always run
+		bool preview_required = isPreviewVisible() || !mAppState->mCullHiddenPreview;
+		if (preview_required == mPreviewCulled)
+		{
+			mPreviewCulled = !preview_required;
+			nap::Logger::info("Preview %s", preview_required ? "visible, resuming preview passes" : "hidden, culling preview passes");
+		}
+
+		// Render the preview and control window at their own rate, compute runs every frame
+		bool preview_due = isRenderDue(mPreviewElapsed, mAppState->mPreviewFramesPerSecond, deltaTime);
+		bool gui_due = isRenderDue(mGUIElapsed, mAppState->mGUIFramesPerSecond, deltaTime);
+		mRenderGraph.setConsumerActive(sPreviewConsumer, preview_required && preview_due);
+		mRenderGraph.setConsumerActive(sGUIConsumer, gui_due);
+
         // tell GUI service what window to render to
         mGuiService->selectWindow(mControlWindow);
 
@@ -260,6 +637,41 @@ namespace nap
 			if (ImGui::Begin("Control", nullptr, ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoTitleBar))
 			{
 				mParameterWindow->drawContent(deltaTime);
+
+				// Passes that ran during the last frame
+				if (ImGui::CollapsingHeader("Render Graph"))
+				{
+					for (const auto& stage : mRenderGraph.getStages())
+					{
+						ImGui::Text("%s %s", stage.mRan ? "[x]" : stage.mCulled ? "[-]" : "[ ]", stage.mName.c_str());
+						for (const auto& pass : stage.mPasses)
+						{
+							if (pass.mTimerScope >= 0 && mGPUTimer != nullptr && mGPUTimer->isMeasured(pass.mTimerScope))
+								ImGui::Text("    %s %s (%llu) %.3f ms", pass.mRan ? "[x]" : pass.mCulled ? "[-]" : "[ ]", pass.mName.c_str(),
+									static_cast<unsigned long long>(pass.mRunCount), mGPUTimer->getMilliseconds(pass.mTimerScope));
+							else
+								ImGui::Text("    %s %s (%llu)", pass.mRan ? "[x]" : pass.mCulled ? "[-]" : "[ ]", pass.mName.c_str(), static_cast<unsigned long long>(pass.mRunCount));
+						}
+					}
+
+					// Swap between gaussian and pyramid bloom to compare GPU time
+					if (mBloom != nullptr && mBloomPyramid != nullptr)
+					{
+						if (ImGui::Checkbox("Bloom Pyramid", &mUseBloomPyramid))
+							applyQuality();
+					}
+				}
+
+				// Preview quality steps lowered by the governor, the laser output is never degraded
+				if (ImGui::CollapsingHeader("Quality"))
+				{
+					ImGui::Text("Level %d / %d, frame cost %.2f ms", mQualityGovernor.getLevel(), mQualityGovernor.getLevelCount(),
+						mQualityGovernor.getAverageCost() < 0.0 ? 0.0 : mQualityGovernor.getAverageCost());
+					for (int i = 0; i < static_cast<int>(sQualitySteps.size()); i++)
+						ImGui::Text("    %s %s", mQualityGovernor.getLevel() > i ? "[reduced]" : "[full]   ", sQualitySteps[i]);
+					if (!mAppState->mGovernQuality)
+						ImGui::Text("Governor disabled");
+				}
 				ImGui::End();
 			}
 		}
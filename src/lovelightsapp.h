@@ -20,6 +20,11 @@
 #include <app.h>
 #include <parameterwindow.h>
 #include <appstate.h>
+#include <rendergraph.h>
+#include <gputimer.h>
+#include <qualitygovernor.h>
+#include <uniforminstance.h>
+#include <chrono>
 
 namespace nap 
 {
@@ -77,6 +82,27 @@ namespace nap
          */
         void onReset();
 
+        /**
+         * Resolves all render stages and passes, called on init and after hot reload
+         */
+        void buildRenderGraph();
+
+        /**
+         * Creates the render and compute pipelines of the scene ahead of the first frame and logs the time it took.
+         * Post-processing pipelines are created by recording their passes once in a warm-up frame that draws offscreen only.
+         */
+        void createPipelines();
+
+        /**
+         * Applies the preview quality level picked by the governor, the laser path is never affected.
+         */
+        void applyQuality();
+
+        /**
+         * @return if the preview window is presented, false when minimized or hidden
+         */
+        bool isPreviewVisible() const                               { return !mPreviewMinimized && !mPreviewHidden; }
+
     private:
         ResourceManager*			mResourceManager = nullptr;			///< Manages all the loaded data
 		RenderService*				mRenderService = nullptr;			///< Render Service that handles render calls
@@ -101,11 +127,28 @@ namespace nap
 
 		ObjectPtr<ParameterWindow>	mParameterWindow;					///< AppGUIs
 
+		RenderGraph					mRenderGraph;						///< Resolved render passes, executed every frame
+		std::unique_ptr<GPUTimer>	mGPUTimer;							///< Measures GPU time of headless passes
+		RenderableComponentInstance* mBloom = nullptr;					///< Gaussian bloom, when available
+		RenderableComponentInstance* mBloomPyramid = nullptr;			///< Pyramid bloom, when available
+		UniformFloatInstance*		mAberration = nullptr;				///< Composite chromatic aberration, when available
+		float						mAberrationValue = 0.0f;			///< Authored chromatic aberration
+		QualityGovernor				mQualityGovernor { 3 };				///< Lowers preview quality when frames exceed their budget
+		std::chrono::steady_clock::time_point mFrameStart;				///< Start of the CPU work of the current frame
+		std::chrono::steady_clock::time_point mLaunchTime = std::chrono::steady_clock::now();	///< Creation of the app, before resources are loaded
+		bool						mStarted = false;					///< If the first frame was logged
+
         nap::Slot<> mHotReloadSlot = { [&]() -> void { onReset(); } };
 
         bool mShowGUI = true;
 		bool mShowCursor = false;
 		bool mRandomizeOffset = false;
         bool mClearStencil = false;
+        bool mUseBloomPyramid = false;                                  ///< Bloom selected in the GUI, the governor can switch to the pyramid
+        bool mPreviewMinimized = false;
+        bool mPreviewHidden = false;
+        bool mPreviewCulled = false;
+        double mPreviewElapsed = 0.0;                                   ///< Time since the preview window was last rendered
+        double mGUIElapsed = 0.0;                                       ///< Time since the control window was last rendered
 	};
 }
@@ -7,10 +7,53 @@
 #include <apprunner.h>
 #include <nap/logger.h>
 #include <guiappeventhandler.h>
+#include <utility/fileutils.h>
+
+// External Includes
+#include <cstdlib>
+
+// Sets an environment variable, unless already set by the user
+static void setDefaultEnv(const char* name, const std::string& value)
+{
+    if (std::getenv(name) != nullptr)
+        return;
+#ifdef _WIN32
+    _putenv_s(name, value.c_str());
+#else
+    setenv(name, value.c_str(), 0);
+#endif
+}
+
+
+// Persists the shader and pipeline cache of the driver in the project 'cache' directory.
+// The driver validates the cache against its own version and device, a stale cache is rebuilt.
+// Only Mesa and NVIDIA drivers read these variables, the app logs on init if the cache is active.
+// Must be called before the render service creates the Vulkan instance.
+static void setupPipelineCache()
+{
+    std::string dir = nap::utility::getExecutableDir() + "/cache/pipelines";
+    if (!nap::utility::dirExists(dir) && !nap::utility::makeDirs(dir))
+    {
+        nap::Logger::warn("Unable to create pipeline cache directory: %s", dir.c_str());
+        return;
+    }
+
+    // Mesa
+    setDefaultEnv("MESA_SHADER_CACHE_DIR", dir);
+
+    // NVIDIA, keep all entries: the cache only holds pipelines of this application
+    setDefaultEnv("__GL_SHADER_DISK_CACHE", "1");
+    setDefaultEnv("__GL_SHADER_DISK_CACHE_PATH", dir);
+    setDefaultEnv("__GL_SHADER_DISK_CACHE_SKIP_CLEANUP", "1");
+}
+
 
 // Main loop
 int main(int argc, char *argv[])
 {
+    // Persist pipelines compiled by the driver in between runs
+    setupPipelineCache();
+
     // Create core
     nap::Core core;
 